@@ -0,0 +1,40 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_ACCESS_TIME_BUFFER_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_ACCESS_TIME_BUFFER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace irods {
+    // Holds access time updates which have not yet been written to the catalog. Repeated accesses of a data object
+    // are coalesced into a single update carrying the latest access time.
+    class access_time_buffer {
+      public:
+        access_time_buffer(std::size_t _maximum_size, std::chrono::seconds _maximum_age);
+
+        access_time_buffer(const access_time_buffer&) = delete;
+        auto operator=(const access_time_buffer&) -> access_time_buffer& = delete;
+
+        // Returns true if the buffer has reached its maximum size or holds an update older than the maximum age,
+        // in which case the caller should take the updates and write them.
+        auto add(const std::string& _logical_path, std::time_t _access_time) -> bool;
+
+        // Removes and returns every buffered update.
+        auto take() -> std::map<std::string, std::time_t>;
+
+        auto empty() const -> bool;
+
+      private:
+        const std::size_t maximum_size_;
+        const std::chrono::seconds maximum_age_;
+
+        mutable std::mutex mutex_;
+        std::map<std::string, std::time_t> access_times_;
+        std::chrono::steady_clock::time_point oldest_;
+    }; // class access_time_buffer
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_ACCESS_TIME_BUFFER_HPP
@@ -0,0 +1,56 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_ACCESS_TIME_INDEX_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_ACCESS_TIME_INDEX_HPP
+
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace irods {
+    // A record of the access times written by this server, kept in local files so that a tiering pass can find the
+    // data objects which were last accessed in a window of time without a range scan over the catalog. Records are
+    // appended to one file per bucket of access time, so a window is read from the few buckets which overlap it.
+    //
+    // The index is only a source of candidates. It does not see access times written by other servers or by other
+    // means, and a data object accessed again later appears in more than one bucket, so candidates must be checked
+    // against the catalog. The files may be shared by every agent on the server; each append is a single write to
+    // a file opened for appending.
+    class access_time_index {
+      public:
+        // How far a resource has been read from the index.
+        struct resource_state {
+            // Every access time before this has been considered by a tiering pass.
+            std::time_t consumed_until;
+            // When the violating objects of the resource were last found with a query over the whole catalog.
+            std::time_t last_full_scan;
+        };
+
+        access_time_index(std::filesystem::path _directory, std::chrono::seconds _bucket_size);
+
+        // Appends the access times to the buckets which contain them.
+        void record(const std::map<std::string, std::time_t>& _access_times) const;
+
+        // Returns the logical paths of the data objects with an access time in [_from, _until).
+        auto read(std::time_t _from, std::time_t _until) const -> std::vector<std::string>;
+
+        auto load_state(const std::string& _resource_name) const -> std::optional<resource_state>;
+
+        void save_state(const std::string& _resource_name, const resource_state& _state) const;
+
+        // Forgets resources whose last full scan was before _stale_before, then removes the buckets which every
+        // remaining resource has consumed.
+        void prune(std::time_t _stale_before) const;
+
+      private:
+        auto bucket_start(std::time_t _access_time) const noexcept -> std::time_t;
+
+        const std::filesystem::path bucket_directory_;
+        const std::filesystem::path state_directory_;
+        const std::time_t bucket_size_;
+    }; // class access_time_index
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_ACCESS_TIME_INDEX_HPP
@@ -0,0 +1,67 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_BATCH_COLLECTOR_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_BATCH_COLLECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace irods {
+    // Gathers items from concurrent producers into batches of a fixed size. The producer whose item completes a
+    // batch receives that batch and is responsible for handing it off, so the work of flushing is spread across the
+    // producing threads instead of being serialized behind a single consumer.
+    template <typename T>
+    class batch_collector {
+      public:
+        explicit batch_collector(std::size_t _batch_size)
+            : batch_size_{std::max<std::size_t>(_batch_size, 1)}
+        {
+            items_.reserve(batch_size_);
+        }
+
+        batch_collector(const batch_collector&) = delete;
+        auto operator=(const batch_collector&) -> batch_collector& = delete;
+
+        // Returns the completed batch if this item filled it. Otherwise, returns an empty list.
+        auto add(T _item) -> std::vector<T>
+        {
+            const std::lock_guard lock{mutex_};
+
+            items_.push_back(std::move(_item));
+
+            if (items_.size() < batch_size_) {
+                return {};
+            }
+
+            return take_items();
+        }
+
+        // Returns whatever has been collected since the last completed batch.
+        auto take_remaining() -> std::vector<T>
+        {
+            const std::lock_guard lock{mutex_};
+            return take_items();
+        }
+
+        auto batch_size() const noexcept -> std::size_t
+        {
+            return batch_size_;
+        }
+
+      private:
+        auto take_items() -> std::vector<T>
+        {
+            std::vector<T> batch;
+            batch.reserve(batch_size_);
+            batch.swap(items_);
+            return batch;
+        }
+
+        const std::size_t batch_size_;
+        std::mutex mutex_;
+        std::vector<T> items_;
+    }; // class batch_collector
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_BATCH_COLLECTOR_HPP
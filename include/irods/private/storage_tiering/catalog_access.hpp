@@ -0,0 +1,221 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_CATALOG_ACCESS_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_CATALOG_ACCESS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct RcComm;
+
+namespace irods {
+    // The catalog requests storage tiering makes. Lookups about individual data objects take a list of logical paths
+    // so that a backend can answer many objects with a single query, and the results are keyed by logical path.
+    // Objects without a match are left out of the results. Everything else a tiering pass asks of the catalog goes
+    // through the general queries and updates at the end, so a tiering pass can be run against a stand-in.
+    class catalog_access {
+      public:
+        // The values and units of an AVU attribute of a data object.
+        using avu_list = std::vector<std::pair<std::string, std::string>>;
+
+        using result_row = std::vector<std::string>;
+
+        virtual ~catalog_access() = default;
+
+        virtual auto data_object_metadata(RcComm* _comm,
+                                          const std::vector<std::string>& _logical_paths,
+                                          const std::string& _attribute_name) -> std::map<std::string, avu_list> = 0;
+
+        // Returns the number of the replica of each data object on one of the leaf resources in _leaf_ids, which is
+        // a comma-separated list of resource IDs.
+        virtual auto replica_numbers(RcComm* _comm,
+                                     const std::vector<std::string>& _logical_paths,
+                                     const std::string& _leaf_ids) -> std::map<std::string, std::string> = 0;
+
+        // Sets an AVU on a data object as an administrator, replacing any others with the same attribute. Returns
+        // the error code of the request. Units may be empty.
+        virtual auto set_data_object_metadata(RcComm* _comm,
+                                              const std::string& _logical_path,
+                                              const std::string& _attribute_name,
+                                              const std::string& _value,
+                                              const std::string& _units) -> int = 0;
+
+        // Changes the units of an AVU on a data object as an administrator, provided that the AVU still has
+        // _current_units. The catalog makes the change as a single compare and set, so when several callers race to
+        // change the same AVU, only the first succeeds and the others receive an error. _current_units may be empty,
+        // _new_units may not.
+        virtual auto change_data_object_metadata_units(RcComm* _comm,
+                                                       const std::string& _logical_path,
+                                                       const std::string& _attribute_name,
+                                                       const std::string& _value,
+                                                       const std::string& _current_units,
+                                                       const std::string& _new_units) -> int = 0;
+
+        // Runs a GenQuery or specific query and calls _on_row for each of the rows until it returns false. A limit
+        // of zero reads every row. An empty query type is a GenQuery.
+        virtual void for_each_row(RcComm* _comm,
+                                  const std::string& _query_string,
+                                  std::uint32_t _limit,
+                                  const std::string& _query_type,
+                                  const std::function<bool(const result_row&)>& _on_row) = 0;
+
+        // Sets an AVU without units on a resource, replacing any others with the same attribute. Returns the error
+        // code of the request.
+        virtual auto set_resource_metadata(RcComm* _comm,
+                                           const std::string& _resource_name,
+                                           const std::string& _attribute_name,
+                                           const std::string& _value) -> int = 0;
+
+        // Runs rule text written for the default policy rule engine plugin, which is how delay rules are queued.
+        // Returns the error code of the request.
+        virtual auto execute_rule(RcComm* _comm, const std::string& _rule_text) -> int = 0;
+
+        // Returns the IDs of the leaf resources of the resource, quoted and comma-separated for an IN condition.
+        // Throws if the resource does not exist.
+        virtual auto leaf_id_list(const std::string& _resource_name) -> std::string = 0;
+
+        // Single object conveniences.
+        auto data_object_metadata(RcComm* _comm, const std::string& _logical_path, const std::string& _attribute_name)
+            -> avu_list;
+
+        auto replica_number(RcComm* _comm, const std::string& _logical_path, const std::string& _leaf_ids)
+            -> std::optional<std::string>;
+
+        // Returns every row of a GenQuery, or the first _limit rows.
+        auto query_rows(RcComm* _comm, const std::string& _query_string, std::uint32_t _limit = 0)
+            -> std::vector<result_row>;
+    }; // class catalog_access
+
+    // Answers lookups with GenQuery, using IN conditions for as many objects as fit in a query.
+    class genquery_catalog_access final : public catalog_access {
+      public:
+        using catalog_access::data_object_metadata;
+
+        auto data_object_metadata(RcComm* _comm,
+                                  const std::vector<std::string>& _logical_paths,
+                                  const std::string& _attribute_name) -> std::map<std::string, avu_list> override;
+
+        auto replica_numbers(RcComm* _comm,
+                             const std::vector<std::string>& _logical_paths,
+                             const std::string& _leaf_ids) -> std::map<std::string, std::string> override;
+
+        auto set_data_object_metadata(RcComm* _comm,
+                                      const std::string& _logical_path,
+                                      const std::string& _attribute_name,
+                                      const std::string& _value,
+                                      const std::string& _units) -> int override;
+
+        auto change_data_object_metadata_units(RcComm* _comm,
+                                               const std::string& _logical_path,
+                                               const std::string& _attribute_name,
+                                               const std::string& _value,
+                                               const std::string& _current_units,
+                                               const std::string& _new_units) -> int override;
+
+        void for_each_row(RcComm* _comm,
+                          const std::string& _query_string,
+                          std::uint32_t _limit,
+                          const std::string& _query_type,
+                          const std::function<bool(const result_row&)>& _on_row) override;
+
+        auto set_resource_metadata(RcComm* _comm,
+                                   const std::string& _resource_name,
+                                   const std::string& _attribute_name,
+                                   const std::string& _value) -> int override;
+
+        auto execute_rule(RcComm* _comm, const std::string& _rule_text) -> int override;
+
+        auto leaf_id_list(const std::string& _resource_name) -> std::string override;
+    }; // class genquery_catalog_access
+
+    // Gathers the lookups made by concurrent threads into one request to the backend. The first thread to make a
+    // lookup of a kind waits for the window to pass, then asks the backend on behalf of every thread which made a
+    // lookup of the same kind in the meantime, using its own connection. General queries and writes are passed
+    // straight through.
+    //
+    // Every lookup waits for up to the window, so this only pays off when many threads make lookups at once.
+    class coalescing_catalog_access final : public catalog_access {
+      public:
+        using catalog_access::data_object_metadata;
+
+        // A lookup which would grow a request beyond _maximum_objects starts a new one.
+        coalescing_catalog_access(std::shared_ptr<catalog_access> _backend,
+                                  std::chrono::microseconds _window,
+                                  std::size_t _maximum_objects = 1024);
+
+        auto data_object_metadata(RcComm* _comm,
+                                  const std::vector<std::string>& _logical_paths,
+                                  const std::string& _attribute_name) -> std::map<std::string, avu_list> override;
+
+        auto replica_numbers(RcComm* _comm,
+                             const std::vector<std::string>& _logical_paths,
+                             const std::string& _leaf_ids) -> std::map<std::string, std::string> override;
+
+        auto set_data_object_metadata(RcComm* _comm,
+                                      const std::string& _logical_path,
+                                      const std::string& _attribute_name,
+                                      const std::string& _value,
+                                      const std::string& _units) -> int override;
+
+        auto change_data_object_metadata_units(RcComm* _comm,
+                                               const std::string& _logical_path,
+                                               const std::string& _attribute_name,
+                                               const std::string& _value,
+                                               const std::string& _current_units,
+                                               const std::string& _new_units) -> int override;
+
+        void for_each_row(RcComm* _comm,
+                          const std::string& _query_string,
+                          std::uint32_t _limit,
+                          const std::string& _query_type,
+                          const std::function<bool(const result_row&)>& _on_row) override;
+
+        auto set_resource_metadata(RcComm* _comm,
+                                   const std::string& _resource_name,
+                                   const std::string& _attribute_name,
+                                   const std::string& _value) -> int override;
+
+        auto execute_rule(RcComm* _comm, const std::string& _rule_text) -> int override;
+
+        auto leaf_id_list(const std::string& _resource_name) -> std::string override;
+
+      private:
+        // The lookups of one kind gathered during a window. The results are shared by every thread which took part.
+        template <typename Result>
+        struct request {
+            std::vector<std::string> logical_paths;
+            std::promise<std::map<std::string, Result>> promise;
+            std::shared_future<std::map<std::string, Result>> results{promise.get_future().share()};
+        };
+
+        template <typename Result>
+        using open_requests = std::map<std::string, std::shared_ptr<request<Result>>>;
+
+        template <typename Result, typename Lookup>
+        auto coalesce(open_requests<Result>& _open,
+                      const std::string& _kind,
+                      const std::vector<std::string>& _logical_paths,
+                      Lookup _lookup) -> std::map<std::string, Result>;
+
+        const std::shared_ptr<catalog_access> backend_;
+        const std::chrono::microseconds window_;
+        const std::size_t maximum_objects_;
+
+        std::mutex mutex_;
+        open_requests<avu_list> metadata_requests_;
+        open_requests<std::string> replica_number_requests_;
+    }; // class coalescing_catalog_access
+
+    // Returns the GenQuery backend, wrapped in the coalescing decorator if _coalescing_window is not zero.
+    auto make_catalog_access(std::chrono::microseconds _coalescing_window) -> std::shared_ptr<catalog_access>;
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_CATALOG_ACCESS_HPP
@@ -1,9 +1,12 @@
 #ifndef IRODS_CAPABILITY_STORAGE_TIERING_CONFIGURATION_HPP
 #define IRODS_CAPABILITY_STORAGE_TIERING_CONFIGURATION_HPP
 
+#include <cstdint>
 #include <string>
 #include <irods/rcMisc.h>
 
+#include <nlohmann/json_fwd.hpp>
+
 namespace irods {
     struct storage_tiering_configuration {
         std::string access_time_attribute{"irods::access_time"};
@@ -15,6 +18,11 @@ namespace irods {
         std::string minimum_restage_tier{"irods::storage_tiering::minimum_restage_tier"};
         std::string preserve_replicas{"irods::storage_tiering::preserve_replicas"};
         std::string object_limit{"irods::storage_tiering::object_limit"};
+        std::string violating_query_cursor{"irods::storage_tiering::violating_query_cursor"};
+        std::string eviction_budget{"irods::storage_tiering::eviction_budget"};
+        std::string eviction_order{"irods::storage_tiering::eviction_order"};
+        std::string data_movement_mode{"irods::storage_tiering::data_movement_mode"};
+        std::string transfer_throughput_attribute{"irods::storage_tiering::transfer_throughput"};
 
         std::string minimum_delay_time{"irods::storage_tiering::minimum_delay_time_in_seconds"};
         std::string maximum_delay_time{"irods::storage_tiering::maximum_delay_time_in_seconds"};
@@ -27,12 +35,37 @@ namespace irods {
         int data_transfer_log_level_value{LOG_DEBUG};
 
         int number_of_scheduling_threads{4};
+        int number_of_concurrent_tier_transitions{1};
+        int maximum_concurrent_catalog_queries{0};
+        int catalog_lookup_coalescing_window_in_microseconds{0};
+        int data_movement_batch_size{1};
+        int scheduling_page_size{100};
+        int access_time_granularity_in_seconds{0};
+        int access_time_write_behind_buffer_size{1};
+        int access_time_write_behind_interval_in_seconds{5};
+        int access_time_registration_batch_size{500};
+        std::string access_time_index_directory{};
+        int access_time_index_bucket_size_in_seconds{3600};
+        int access_time_index_full_scan_interval_in_seconds{86400};
+        std::string metrics_directory{};
+        int metrics_write_interval_in_seconds{10};
+        std::string movement_trace_log_path{};
+        std::string dry_run_candidate_list_path{};
+        std::int64_t large_object_size_in_bytes{1024 * 1024 * 1024};
+        int maximum_transfer_threads{16};
         int default_minimum_delay_time{1};
         int default_maximum_delay_time{30};
         std::string default_data_movement_parameters{"<EF>60s REPEAT UNTIL SUCCESS OR 5 TIMES</EF>"};
 
         const std::string instance_name{};
         explicit storage_tiering_configuration(const std::string& _instance_name);
+
+        // Reads the configuration from a plugin_specific_configuration stanza instead of the server configuration.
+        storage_tiering_configuration(const std::string& _instance_name,
+                                      const nlohmann::json& _plugin_specific_configuration);
+
+      private:
+        void load(const nlohmann::json& _config);
     };
 } // namespace irods
 
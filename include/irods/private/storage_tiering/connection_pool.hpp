@@ -0,0 +1,79 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_CONNECTION_POOL_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_CONNECTION_POOL_HPP
+
+#include <irods/client_connection.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct RcComm;
+
+namespace irods {
+    // A bounded pool of authenticated loopback connections shared by the scheduling threads and the PEP handlers of
+    // the plugin instance. Connections are established lazily, so agents which never need one never connect.
+    class storage_tiering_connection_pool {
+      public:
+        // A checked out connection. The connection is returned to the pool when the proxy is destroyed.
+        class connection_proxy {
+          public:
+            connection_proxy(const connection_proxy&) = delete;
+            auto operator=(const connection_proxy&) -> connection_proxy& = delete;
+
+            connection_proxy(connection_proxy&& _other) noexcept;
+            auto operator=(connection_proxy&&) -> connection_proxy& = delete;
+
+            ~connection_proxy();
+
+            explicit operator RcComm&() const noexcept;
+
+            // Marks the connection as broken. It is disconnected instead of being returned to the pool.
+            void invalidate() noexcept;
+
+          private:
+            friend class storage_tiering_connection_pool;
+
+            connection_proxy(storage_tiering_connection_pool& _pool,
+                             std::unique_ptr<experimental::client_connection> _conn) noexcept;
+
+            storage_tiering_connection_pool* pool_;
+            std::unique_ptr<experimental::client_connection> conn_;
+            bool healthy_;
+        }; // class connection_proxy
+
+        explicit storage_tiering_connection_pool(int _size,
+                                                 std::chrono::seconds _idle_check_interval = std::chrono::seconds{30});
+
+        storage_tiering_connection_pool(const storage_tiering_connection_pool&) = delete;
+        auto operator=(const storage_tiering_connection_pool&) -> storage_tiering_connection_pool& = delete;
+
+        // Blocks until a connection is available. Connections which have been idle for longer than the idle check
+        // interval are verified with a round trip to the server and replaced if they no longer work.
+        auto get_connection() -> connection_proxy;
+
+        auto size() const noexcept -> int;
+
+        // Returns whether the error code indicates that the connection it was received on can no longer be used.
+        static auto is_connection_error(int _error_code) noexcept -> bool;
+
+      private:
+        struct idle_connection {
+            std::unique_ptr<experimental::client_connection> conn;
+            std::chrono::steady_clock::time_point returned_at;
+        };
+
+        void return_connection(std::unique_ptr<experimental::client_connection> _conn, bool _healthy);
+
+        const int size_;
+        const std::chrono::seconds idle_check_interval_;
+
+        std::mutex mutex_;
+        std::condition_variable connection_returned_;
+        std::vector<idle_connection> idle_;
+        int checked_out_{0};
+    }; // class storage_tiering_connection_pool
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_CONNECTION_POOL_HPP
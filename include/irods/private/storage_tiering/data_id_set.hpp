@@ -0,0 +1,61 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_DATA_ID_SET_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_DATA_ID_SET_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace irods {
+    // A concurrent set of 64-bit data IDs used to remember which data objects have already been handled during a
+    // tiering pass. The keys are spread across independently locked stripes, each of which is an open addressing
+    // hash table of plain integers, so concurrent inserts rarely wait on one another and each entry costs a few
+    // bytes rather than a full logical path.
+    class data_id_set {
+      public:
+        explicit data_id_set(std::size_t _number_of_stripes = 64);
+
+        data_id_set(const data_id_set&) = delete;
+        auto operator=(const data_id_set&) -> data_id_set& = delete;
+
+        // Returns true if the key was not already in the set.
+        auto insert(std::uint64_t _key) -> bool;
+
+        auto contains(std::uint64_t _key) const -> bool;
+
+        auto size() const -> std::size_t;
+
+        // The number of bytes allocated by the set, including unused slots.
+        auto memory_usage() const -> std::size_t;
+
+        // The number of times a thread had to wait for another thread to release a stripe.
+        auto contended_lock_acquisitions() const noexcept -> std::uint64_t;
+
+        // Produces a key for data objects which are only known by their logical path, e.g. those returned by a
+        // violating query which does not select DATA_ID.
+        static auto hash_logical_path(std::string_view _logical_path) noexcept -> std::uint64_t;
+
+      private:
+        struct stripe {
+            mutable std::mutex mutex;
+            std::vector<std::uint64_t> slots;
+            std::size_t size{0};
+            // The empty slot marker cannot be stored in the table itself.
+            bool contains_empty_key{false};
+        };
+
+        auto lock_stripe(std::uint64_t _hash) const -> std::pair<stripe&, std::unique_lock<std::mutex>>;
+
+        static void grow(stripe& _stripe);
+
+        std::size_t stripe_mask_;
+        std::unique_ptr<stripe[]> stripes_;
+        mutable std::atomic<std::uint64_t> contended_lock_acquisitions_{0};
+    }; // class data_id_set
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_DATA_ID_SET_HPP
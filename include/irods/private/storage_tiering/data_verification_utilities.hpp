@@ -1,19 +1,52 @@
 #ifndef IRODS_CAPABILITY_STORAGE_TIERING_DATA_VERIFICATION_UTILITIES_HPP
 #define IRODS_CAPABILITY_STORAGE_TIERING_DATA_VERIFICATION_UTILITIES_HPP
 
+#include "irods/private/storage_tiering/configuration.hpp"
+
 #include <irods/rcConnect.h>
 
 #include <string>
 
 namespace irods {
+    // The destination replica is checksummed and verified against the source replica's checksum by the server as
+    // part of the replication, so verification compares the catalog checksums instead of reading either replica.
+    inline const std::string VERIFY_CHECKSUM_ON_REPLICATION{"checksum_on_replication"};
+
     bool verify_replica_for_destination_resource(
-        rcComm_t*          _comm,
-        const std::string& _instance_name,
-        const std::string& _verification_type,
-        const std::string& _object_path,
-        const std::string& _source_resource,
-        const std::string& _destination_resource);
+        rcComm_t*                            _comm,
+        const storage_tiering_configuration& _config,
+        const std::string&                   _verification_type,
+        const std::string&                   _object_path,
+        const std::string&                   _source_resource,
+        const std::string&                   _destination_resource);
+
+    // The catalog attributes of a replica which are compared when verifying a copy of it.
+    struct replica_attributes {
+        std::string file_path;
+        std::string data_size;
+        std::string data_hierarchy;
+        std::string data_checksum;
+    };
+
+    // Captures the source replica before it is physically moved. If the verification type compares checksums and
+    // the catalog has none for the replica, one is computed while the replica still exists.
+    auto capture_replica_for_physical_move(
+        rcComm_t*                            _comm,
+        const storage_tiering_configuration& _config,
+        const std::string&                   _verification_type,
+        const std::string&                   _object_path,
+        const std::string&                   _source_resource) -> replica_attributes;
 
+    // Verifies the replica on the destination resource against the source replica as it was before the move. The
+    // moved replica keeps the catalog attributes of the source replica, so catalog verification checks the size of
+    // the file on the destination resource, and checksum verification computes the checksum of the moved file.
+    bool verify_physically_moved_replica(
+        rcComm_t*                            _comm,
+        const storage_tiering_configuration& _config,
+        const std::string&                   _verification_type,
+        const std::string&                   _object_path,
+        const replica_attributes&            _source,
+        const std::string&                   _destination_resource);
 
 } // namespace irods
 
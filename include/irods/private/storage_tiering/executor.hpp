@@ -0,0 +1,104 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_EXECUTOR_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_EXECUTOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace irods {
+    // A fixed-size set of worker threads which lives as long as the plugin instance. The threads are started by the
+    // first task posted to the executor, so agents which never schedule any work never start them.
+    class executor {
+      public:
+        explicit executor(int _size);
+
+        executor(const executor&) = delete;
+        auto operator=(const executor&) -> executor& = delete;
+
+        // Runs the tasks which have already been posted before joining the threads.
+        ~executor();
+
+        // Throws if the executor has been stopped.
+        void post(std::function<void()> _task);
+
+        // Stops accepting tasks, waits for the queued tasks to finish and joins the threads.
+        void stop();
+
+        auto size() const noexcept -> int;
+
+        // The number of tasks which have been posted but not yet picked up by a thread.
+        auto queue_depth() const -> std::size_t;
+
+        // The number of threads currently running a task.
+        auto busy_threads() const noexcept -> int;
+
+        // The fraction of the available thread time spent running tasks since the threads were started.
+        auto utilization() const -> double;
+
+      private:
+        void run();
+
+        const int size_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable task_posted_;
+        std::deque<std::function<void()>> tasks_;
+        std::vector<std::thread> threads_;
+        std::chrono::steady_clock::time_point started_at_;
+        bool stopping_{false};
+
+        std::atomic<int> busy_threads_{0};
+        std::atomic<std::int64_t> busy_nanoseconds_{0};
+    }; // class executor
+
+    // Tracks a set of tasks posted to an executor so that the poster can wait for just those tasks. Errors thrown by
+    // the tasks are collected rather than propagated.
+    class task_group {
+      public:
+        using errors_type = std::vector<std::tuple<int, std::string>>;
+
+        explicit task_group(executor& _executor);
+
+        task_group(const task_group&) = delete;
+        auto operator=(const task_group&) -> task_group& = delete;
+
+        // Waits for any tasks which are still running.
+        ~task_group();
+
+        void post(std::function<void()> _task);
+
+        // Waits for every task posted so far and returns the errors they threw.
+        auto wait() -> errors_type;
+
+      private:
+        executor& executor_;
+
+        std::mutex mutex_;
+        std::condition_variable task_finished_;
+        std::size_t pending_{0};
+        errors_type errors_;
+    }; // class task_group
+
+    // The executors owned by the plugin instance. Scheduling tasks never wait on other tasks, while tier
+    // transitions wait on the scheduling tasks they post, so the two must not share threads.
+    struct storage_tiering_executors {
+        storage_tiering_executors(int _number_of_scheduling_threads, int _number_of_transition_threads);
+
+        // Drains the transitions first, as they may still post scheduling tasks.
+        void stop();
+
+        executor transitions;
+        executor scheduling;
+    }; // struct storage_tiering_executors
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_EXECUTOR_HPP
@@ -0,0 +1,113 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_METRICS_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_METRICS_HPP
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+
+namespace irods {
+    // Counters and latency histograms for the work done by storage tiering in this process. Recording is lock-free
+    // once a transition has been seen, so the scheduling threads and data movements never wait on each other to
+    // record what they did.
+    //
+    // Tiering passes and data movements run in different agents, so each agent adds what it has recorded to totals
+    // kept in a shared directory. Those totals are also rendered in the Prometheus text format for collection by
+    // the node_exporter textfile collector.
+    class tiering_metrics {
+      public:
+        // Counters for the data movements from one resource to another in a tier group.
+        struct transition_counters {
+            std::atomic<std::uint64_t> objects_scanned{0};
+            std::atomic<std::uint64_t> objects_skipped{0};
+            std::atomic<std::uint64_t> objects_queued{0};
+            std::atomic<std::uint64_t> objects_moved{0};
+            std::atomic<std::uint64_t> bytes_moved{0};
+        };
+
+        enum class operation { queue_data_movement, replication, physical_move, verification, trim };
+
+        // Durations are counted in fixed buckets so that the histograms of different agents can be added together.
+        class latency_histogram {
+          public:
+            static constexpr std::array<double, 12> bucket_bounds_in_seconds{
+                0.005, 0.01, 0.05, 0.1, 0.5, 1, 5, 10, 30, 60, 300, 1800};
+
+            void observe(std::chrono::steady_clock::duration _duration) noexcept;
+
+          private:
+            friend class tiering_metrics;
+
+            // The last count is for durations beyond the largest bound.
+            std::array<std::atomic<std::uint64_t>, bucket_bounds_in_seconds.size() + 1> counts_{};
+            std::atomic<std::uint64_t> sum_in_microseconds_{0};
+        }; // class latency_histogram
+
+        // Records the time from its construction to its destruction in the histogram for an operation.
+        class scoped_timer {
+          public:
+            explicit scoped_timer(latency_histogram& _histogram) noexcept;
+
+            scoped_timer(const scoped_timer&) = delete;
+            auto operator=(const scoped_timer&) -> scoped_timer& = delete;
+
+            ~scoped_timer();
+
+          private:
+            latency_histogram& histogram_;
+            const std::chrono::steady_clock::time_point start_;
+        }; // class scoped_timer
+
+        static auto instance() -> tiering_metrics&;
+
+        tiering_metrics(const tiering_metrics&) = delete;
+        auto operator=(const tiering_metrics&) -> tiering_metrics& = delete;
+
+        // The counters remain valid for the life of the process, so callers may hold on to them.
+        auto transition(const std::string& _group_name,
+                        const std::string& _source_resource,
+                        const std::string& _destination_resource) -> transition_counters&;
+
+        auto histogram(operation _operation) noexcept -> latency_histogram&;
+
+        // Returns what this process has recorded and not yet written to a metrics directory.
+        auto to_json() -> nlohmann::json;
+
+        // Adds what this process has recorded since it last wrote to the totals in _directory and rewrites the
+        // Prometheus text file there.
+        void write(const std::filesystem::path& _directory);
+
+        // Writes as above, unless this process last wrote less than _minimum_interval ago.
+        void write_if_due(const std::filesystem::path& _directory, std::chrono::seconds _minimum_interval);
+
+        // Returns the totals kept in _directory.
+        static auto read(const std::filesystem::path& _directory) -> nlohmann::json;
+
+      private:
+        tiering_metrics();
+
+        // Returns what this process has recorded and resets it.
+        auto take() -> nlohmann::json;
+
+        auto collect(bool _reset) -> nlohmann::json;
+
+        using transition_key = std::tuple<std::string, std::string, std::string>;
+
+        std::shared_mutex transitions_mutex_;
+        std::map<transition_key, std::unique_ptr<transition_counters>> transitions_;
+
+        std::array<latency_histogram, 5> histograms_;
+
+        std::atomic<std::chrono::steady_clock::rep> last_write_{0};
+    }; // class tiering_metrics
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_METRICS_HPP
@@ -0,0 +1,70 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_MOVEMENT_TRACE_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_MOVEMENT_TRACE_HPP
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace irods {
+    // Timing spans for the stages of a data movement, appended as JSON lines to a local trace log. A data movement is
+    // scheduled by a tiering pass and carried out later by the agent which runs its delay rule, so a movement ID is
+    // generated when the delay rule is queued and carried in the rule. Every span of the movement, in either agent,
+    // is recorded with that ID.
+    class movement_trace {
+      public:
+        using clock_type = std::chrono::system_clock;
+
+        // Records the time from its construction to its destruction as a span of the trace. A span which ends with
+        // an exception in flight is recorded as failed.
+        class span {
+          public:
+            span(const movement_trace& _trace, std::string _name, std::string _object_path = {});
+
+            span(const span&) = delete;
+            auto operator=(const span&) -> span& = delete;
+
+            ~span();
+
+          private:
+            const movement_trace& trace_;
+            const std::string name_;
+            const std::string object_path_;
+            const clock_type::time_point start_;
+            const int uncaught_exceptions_;
+        }; // class span
+
+        // Returns a random identifier for a new data movement.
+        static auto make_movement_id() -> std::string;
+
+        // Returns _time as microseconds since the epoch, as carried in the delay rule. The value has a fixed number
+        // of digits, so the size of a delay rule does not change when it is stamped.
+        static auto to_microseconds(clock_type::time_point _time) noexcept -> std::int64_t;
+
+        static auto from_microseconds(std::int64_t _microseconds) noexcept -> clock_type::time_point;
+
+        // A trace with an empty log path records nothing. The attributes are added to every span.
+        movement_trace(std::filesystem::path _log_path, std::string _movement_id, nlohmann::json _attributes);
+
+        auto enabled() const noexcept -> bool;
+
+        auto movement_id() const noexcept -> const std::string&;
+
+        // Appends a span to the trace log. Failures are logged and otherwise ignored, so that tracing never fails a
+        // data movement.
+        void record(const std::string& _name,
+                    const std::string& _object_path,
+                    clock_type::time_point _start,
+                    clock_type::time_point _end,
+                    bool _failed = false) const noexcept;
+
+      private:
+        const std::filesystem::path log_path_;
+        const std::string movement_id_;
+        const nlohmann::json attributes_;
+    }; // class movement_trace
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_MOVEMENT_TRACE_HPP
@@ -0,0 +1,44 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_RESOURCE_METADATA_SNAPSHOT_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_RESOURCE_METADATA_SNAPSHOT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct RcComm;
+
+namespace irods {
+    class catalog_access;
+
+    // An immutable copy of the storage tiering AVUs attached to a set of resources. It is loaded with a single
+    // query at the start of a tiering pass so that the per-object lookups made while scheduling data movements do
+    // not go back to the catalog for answers which cannot change during the pass.
+    class resource_metadata_snapshot {
+      public:
+        using metadata_results = std::vector<std::pair<std::string, std::string>>;
+
+        resource_metadata_snapshot(catalog_access& _catalog,
+                                   RcComm* _comm,
+                                   const std::vector<std::string>& _resource_names,
+                                   const std::vector<std::string>& _attribute_names);
+
+        // Returns the (value, units) pairs for the attribute on the resource. An empty list means the resource has
+        // no such AVU. A nullptr means that the snapshot cannot answer for this resource or attribute and the caller
+        // must query the catalog.
+        auto find(const std::string& _resource_name, const std::string& _attribute_name) const
+            -> const metadata_results*;
+
+        auto catalog_queries_avoided() const noexcept -> std::uint64_t;
+
+      private:
+        std::vector<std::string> resource_names_;
+        std::vector<std::string> attribute_names_;
+        std::map<std::string, std::map<std::string, metadata_results>> metadata_;
+        mutable std::atomic<std::uint64_t> catalog_queries_avoided_{0};
+    }; // class resource_metadata_snapshot
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_RESOURCE_METADATA_SNAPSHOT_HPP
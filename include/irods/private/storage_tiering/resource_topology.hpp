@@ -0,0 +1,48 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_RESOURCE_TOPOLOGY_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_RESOURCE_TOPOLOGY_HPP
+
+#include <irods/irods_resource_manager.hpp>
+#include <irods/rodsType.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace irods {
+    // A per-agent index of the leaf resources beneath each resource used by storage tiering. Entries are built from
+    // the resource manager the first time a resource is looked up and are rebuilt if the resource manager has since
+    // replaced the resource, so the leaf bundles are gathered and formatted once instead of on every query.
+    class resource_topology {
+      public:
+        struct resource_entry {
+            std::vector<rodsLong_t> leaf_ids;
+            // The leaf IDs quoted and comma-separated, ready for use in a GenQuery IN condition.
+            std::string leaf_id_list;
+        };
+
+        static auto instance() -> resource_topology&;
+
+        resource_topology(const resource_topology&) = delete;
+        auto operator=(const resource_topology&) -> resource_topology& = delete;
+
+        // Throws if the resource does not exist.
+        auto find(const std::string& _resource_name) -> std::shared_ptr<const resource_entry>;
+
+        auto leaf_id_list(const std::string& _resource_name) -> std::string;
+
+      private:
+        resource_topology() = default;
+
+        struct cached_entry {
+            resource_ptr resource;
+            std::shared_ptr<const resource_entry> entry;
+        };
+
+        std::mutex mutex_;
+        std::unordered_map<std::string, cached_entry> resources_;
+    }; // class resource_topology
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_RESOURCE_TOPOLOGY_HPP
@@ -1,14 +1,28 @@
 #ifndef IRODS_CAPABILITY_STORAGE_TIERING_HPP
 #define IRODS_CAPABILITY_STORAGE_TIERING_HPP
 
+#include "irods/private/storage_tiering/catalog_access.hpp"
 #include "irods/private/storage_tiering/configuration.hpp"
+#include "irods/private/storage_tiering/connection_pool.hpp"
+#include "irods/private/storage_tiering/executor.hpp"
+#include "irods/private/storage_tiering/resource_metadata_snapshot.hpp"
 
 #include <irods/rcMisc.h>
 
 #include <boost/any.hpp>
 
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <ctime>
 #include <list>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <semaphore>
+#include <set>
 #include <string>
+#include <vector>
 
 struct RcComm;
 struct RuleExecInfo;
@@ -21,6 +35,7 @@ namespace irods {
             static const std::string storage_tiering;
             static const std::string data_movement;
             static const std::string access_time;
+            static const std::string metrics;
         };
 
         struct schedule {
@@ -28,11 +43,28 @@ namespace irods {
             static const std::string data_movement;
         };
 
-        storage_tiering(RcComm* _comm, RuleExecInfo* _rei, const std::string& _instance_name);
+        // Every catalog request is made through _catalog. If it is null, the catalog is queried with GenQuery.
+        storage_tiering(RcComm* _comm,
+                        RuleExecInfo* _rei,
+                        std::shared_ptr<const storage_tiering_configuration> _config,
+                        std::shared_ptr<storage_tiering_connection_pool> _connection_pool,
+                        std::shared_ptr<storage_tiering_executors> _executors,
+                        std::shared_ptr<catalog_access> _catalog = nullptr);
 
         void apply_policy_for_tier_group(
             const std::string& _group);
 
+        // Runs the tier transitions of all of the groups in a single pass. Transitions are started in round-robin
+        // order across the groups and up to number_of_concurrent_tier_transitions of them run at once.
+        void apply_policy_for_tier_groups(
+            const std::vector<std::string>& _groups);
+
+        // Evaluates the violating queries of every tier transition of the groups as a tiering pass would, without
+        // flagging or enqueueing anything, and returns a report of what the pass would schedule. When
+        // _candidate_list_path is not empty, every violating replica is also written to it as a line of JSON.
+        auto plan_policy_for_tier_groups(const std::vector<std::string>& _groups,
+                                         const std::string& _candidate_list_path) -> nlohmann::json;
+
         void migrate_object_to_minimum_restage_tier(
                  const std::string& _object_path,
                  const std::string& _source_resource);
@@ -49,18 +81,77 @@ namespace irods {
             const std::string& _destination_resource);
 
         private:
-          void set_migration_metadata_flag_for_object(RcComm* _comm, const std::string& _object_path);
+          // A transition moves violating objects from one tier of a group to the next.
+          struct tier_transition {
+              std::string group;
+              std::string partial_list;
+              std::string source_resource;
+              std::string destination_resource;
+          };
+
+          // A data object identified by a violating query, along with the replica which violates the policy.
+          struct violating_object {
+              std::string object_path;
+              std::string source_replica_number;
+              // The size of the replica on the source resource, once it has been read from the catalog.
+              std::optional<rodsLong_t> data_size;
+          };
+
+          // A tiering pass which uses the local access time index for the default query. A full scan runs the
+          // query over the whole catalog as usual. Otherwise, the query is only run over the candidates read from
+          // the index.
+          struct access_time_index_pass {
+              std::time_t threshold;
+              bool full_scan;
+              std::vector<std::string> candidates;
+          };
+
+          // A query which identifies violating objects on a source resource. The default query also selects
+          // DATA_ID as a sixth column. A resumable query orders by that column and only returns objects beyond the
+          // cursor persisted for the resource by the previous tiering pass. An ordered query selects DATA_SIZE and
+          // the access time as a seventh and eighth column and returns objects in the named eviction order.
+          struct violating_query {
+              std::string query_string;
+              std::string query_type;
+              bool selects_data_id;
+              bool resumable;
+              std::string eviction_order;
+              std::optional<access_time_index_pass> index_pass;
+          };
+
+          // The amount of data a single tiering pass may schedule for migration off of a source resource, counted
+          // either in bytes or in data objects.
+          struct eviction_budget {
+              std::uint64_t limit;
+              bool counts_bytes;
+          };
 
           void unset_migration_metadata_flag_for_object(RcComm* _comm, const std::string& _object_path);
 
-          bool object_has_migration_metadata_flag(RcComm* _comm, const std::string& _object_path);
+          bool mark_object_for_migration(RcComm* _comm, const std::string& _object_path);
+
+          // Sets the migration scheduled flag on each of the objects which does not already have it and removes
+          // the others from _objects. Returns the number of objects which could not be marked.
+          auto mark_objects_for_migration(RcComm* _comm, std::vector<violating_object>& _objects) -> std::size_t;
 
-          bool skip_object_in_lower_tier(RcComm* _comm,
-                                         const std::string& _object_path,
-                                         const std::string& _partial_list);
+          // Sets the data size of each of the objects from its replica on the source resource.
+          void set_data_sizes_for_objects(RcComm* _comm,
+                                          std::vector<violating_object>& _objects,
+                                          const std::string& _source_resource);
+
+          // Removes from _objects those which already have a replica on one of the resources in _partial_list.
+          void skip_objects_in_lower_tiers(RcComm* _comm,
+                                           std::vector<violating_object>& _objects,
+                                           const std::string& _partial_list);
 
           std::string make_partial_list(resource_index_map::iterator _itr, resource_index_map::iterator _end);
 
+          // Returns the transitions of each group in tier order and appends the name of every resource in the
+          // groups to _resource_names. Groups without resources are logged and left out.
+          auto make_tier_transitions(const std::vector<std::string>& _groups,
+                                     std::vector<std::string>& _resource_names)
+              -> std::vector<std::vector<tier_transition>>;
+
           void update_access_time_for_data_object(const std::string& _object_path);
 
           std::string get_metadata_for_data_object(RcComm* _comm,
@@ -79,12 +170,12 @@ namespace irods {
 
           resource_index_map get_tier_group_resource_ids_and_indices(RcComm* _comm, const std::string& _group_name);
 
-          std::string get_leaf_resources_string(const std::string& _resource_name);
-
           bool get_preserve_replicas_for_resc(RcComm* _comm, const std::string& _source_resource);
 
           std::string get_verification_for_resc(RcComm* _comm, const std::string& _resource_name);
 
+          std::string get_data_movement_mode_for_resc(RcComm* _comm, const std::string& _resource_name);
+
           std::string get_restage_tier_resource_name(RcComm* _comm, const std::string& _resource_name);
 
           auto get_group_tier_for_resource(RcComm* _comm,
@@ -105,10 +196,38 @@ namespace irods {
 
           std::string get_tier_time_for_resc(RcComm* _comm, const std::string& _resource_name);
 
-          metadata_results get_violating_queries_for_resource(RcComm* _comm, const std::string& _resource_name);
+          // The access time index is only read for the default query when _use_access_time_index is set.
+          std::vector<violating_query> get_violating_queries_for_resource(RcComm* _comm,
+                                                                          const std::string& _resource_name,
+                                                                          uint32_t _object_limit,
+                                                                          const std::string& _eviction_order,
+                                                                          bool _use_access_time_index);
+
+          // Returns the index pass for the default query on the resource, or nothing if the index is not enabled.
+          auto make_access_time_index_pass(const std::string& _resource_name, std::time_t _threshold)
+              -> std::optional<access_time_index_pass>;
+
+          // Records that every access time before the threshold of the pass has been considered for the resource.
+          void complete_access_time_index_pass(const std::string& _resource_name,
+                                               const access_time_index_pass& _pass);
+
+          auto get_eviction_budget_for_resource(RcComm* _comm, const std::string& _resource_name)
+              -> std::optional<eviction_budget>;
+
+          // Returns the order in which violating objects are considered for migration, or an empty string when
+          // the order does not matter. Resources with an eviction budget default to the oldest access time first.
+          std::string get_eviction_order_for_resource(RcComm* _comm,
+                                                      const std::string& _resource_name,
+                                                      bool _has_eviction_budget);
 
           uint32_t get_object_limit_for_resource(RcComm* _comm, const std::string& _resource_name);
 
+          uint64_t get_violating_query_cursor_for_resource(RcComm* _comm, const std::string& _resource_name);
+
+          void set_violating_query_cursor_for_resource(RcComm* _comm,
+                                                       const std::string& _resource_name,
+                                                       uint64_t _cursor);
+
           void queue_data_movement(RcComm* _comm,
                                    const std::string& _plugin_instance_name,
                                    const std::string& _group_name,
@@ -120,16 +239,62 @@ namespace irods {
                                    const bool _preserve_replicas,
                                    const std::string& _data_movement_params);
 
+          void enqueue_data_movement(RcComm* _comm,
+                                     const std::string& _plugin_instance_name,
+                                     const std::string& _group_name,
+                                     const std::string& _object_path,
+                                     const std::string& _source_replica_number,
+                                     const std::string& _source_resource,
+                                     const std::string& _destination_resource,
+                                     const std::string& _verification_type,
+                                     const bool _preserve_replicas,
+                                     const std::string& _data_movement_params,
+                                     const std::optional<rodsLong_t>& _data_size);
+
+          auto make_resource_metadata_snapshot(RcComm* _comm, const std::vector<std::string>& _resource_names)
+              -> std::shared_ptr<const resource_metadata_snapshot>;
+
+          void queue_data_movement_batch(RcComm* _comm,
+                                         const std::string& _group_name,
+                                         const std::vector<violating_object>& _objects,
+                                         const std::string& _source_resource,
+                                         const std::string& _destination_resource,
+                                         const std::string& _verification_type,
+                                         const bool _preserve_replicas,
+                                         const std::string& _data_movement_params);
+
+          int enqueue_rule(RcComm* _comm, const nlohmann::json& _rule);
+
           void migrate_violating_data_objects(RcComm* _comm,
                                               const std::string& _group_name,
                                               const std::string& _partial_list,
                                               const std::string& _source_resource,
                                               const std::string& _destination_resource);
 
+          // Returns the dry run report for a single transition. Candidates are written to _candidates if it is not
+          // null.
+          auto plan_violating_data_objects(RcComm* _comm, const tier_transition& _transition, std::ostream* _candidates)
+              -> nlohmann::json;
+
           // Attributes
           RuleExecInfo* rei_;
           RcComm* comm_;
-          storage_tiering_configuration config_;
+          // Shared with the rest of the plugin. The snapshot is kept alive for the lifetime of this object.
+          std::shared_ptr<const storage_tiering_configuration> config_snapshot_;
+          const storage_tiering_configuration& config_;
+          std::shared_ptr<storage_tiering_connection_pool> connection_pool_;
+          std::shared_ptr<storage_tiering_executors> executors_;
+
+          // Every query and update of the catalog. Shared by the threads working for this object so that their
+          // lookups may be coalesced.
+          std::shared_ptr<catalog_access> catalog_;
+
+          // Resource metadata for the tier groups currently being processed, if any.
+          std::shared_ptr<const resource_metadata_snapshot> resource_metadata_;
+
+          // Limits the number of violating queries running against the catalog at once across all concurrent tier
+          // transitions.
+          std::unique_ptr<std::counting_semaphore<>> catalog_query_slots_;
     }; // class storage_tiering
 }; // namespace irods
 
@@ -0,0 +1,31 @@
+#ifndef IRODS_CAPABILITY_STORAGE_TIERING_TRANSFER_ESTIMATE_HPP
+#define IRODS_CAPABILITY_STORAGE_TIERING_TRANSFER_ESTIMATE_HPP
+
+#include <optional>
+#include <string>
+
+namespace irods {
+    // What has been learned about replicating large data objects from one resource to another: the number of
+    // parallel transfer threads to use next, the smoothed throughput observed so far and the direction in which the
+    // number of threads is being adjusted.
+    struct transfer_estimate {
+        int number_of_threads;
+        double bytes_per_second;
+        int direction;
+
+        // The estimate used for a pair of resources which has not been measured yet.
+        static auto initial(int _maximum_number_of_threads) -> transfer_estimate;
+
+        // Parses the value of a transfer throughput AVU. Returns nothing if the value is malformed.
+        static auto from_string(const std::string& _value) -> std::optional<transfer_estimate>;
+
+        auto to_string() const -> std::string;
+
+        // Folds an observed throughput into the estimate and picks the number of threads for the next transfer.
+        // The number of threads keeps moving in the same direction for as long as the throughput improves and
+        // turns around when it gets worse.
+        auto update(double _observed_bytes_per_second, int _maximum_number_of_threads) const -> transfer_estimate;
+    }; // struct transfer_estimate
+} // namespace irods
+
+#endif // IRODS_CAPABILITY_STORAGE_TIERING_TRANSFER_ESTIMATE_HPP
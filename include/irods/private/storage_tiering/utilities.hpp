@@ -5,6 +5,10 @@
 #include <irods/irods_exception.hpp>
 #include <irods/rodsError.h>
 
+#include <cstddef>
+#include <string>
+#include <vector>
+
 namespace irods {
 
     std::string any_to_string(boost::any& _a);
@@ -23,6 +27,24 @@ namespace irods {
         const std::string&    _action,
         std::list<boost::any> _args);
 
+    // A group of data objects which can be selected together with one GenQuery condition on COLL_NAME and
+    // DATA_NAME. The condition matches a superset of the data objects, so results must be checked against
+    // logical_paths.
+    struct logical_path_query_chunk {
+        std::string collection_names;
+        std::string data_names;
+        std::vector<std::string> logical_paths;
+    };
+
+    // Splits the logical paths into chunks whose quoted, comma-separated IN-lists together stay within
+    // _maximum_condition_length characters. A chunk always holds at least one logical path.
+    auto make_logical_path_query_chunks(const std::vector<std::string>& _logical_paths,
+                                        std::size_t _maximum_condition_length = 2048)
+        -> std::vector<logical_path_query_chunk>;
+
+    // Joins a COLL_NAME and DATA_NAME from a query result into a logical path.
+    auto make_logical_path(const std::string& _collection_name, const std::string& _data_name) -> std::string;
+
 } // namespace irods
 
 #endif // IRODS_CAPABILITY_STORAGE_TIERING_UTILITIES_HPP
@@ -2,7 +2,9 @@ import os
 import sys
 import shutil
 import contextlib
+import json
 import os.path
+import tempfile
 import unittest
 
 import time
@@ -113,6 +115,34 @@ def storage_tiering_configured_with_log(arg=None, sleep_time=1):
     IrodsController().reload_configuration()
 
 
+@contextlib.contextmanager
+def storage_tiering_configured_with_options(plugin_specific_configuration, sleep_time=1):
+    filename = paths.server_config_path()
+    with lib.file_backed_up(filename):
+        irods_config = IrodsConfig()
+        irods_config.server_config['advanced_settings']['delay_server_sleep_time_in_seconds'] = sleep_time
+
+        irods_config.server_config['plugin_configuration']['rule_engines'].insert(0,
+            {
+                "instance_name": "irods_rule_engine_plugin-unified_storage_tiering-instance",
+                "plugin_name": "irods_rule_engine_plugin-unified_storage_tiering",
+                "plugin_specific_configuration": plugin_specific_configuration
+            }
+        )
+
+        irods_config.commit(irods_config.server_config, irods_config.server_config_path)
+        try:
+            # Reload configuration after edits are made so that they take effect in the server.
+            IrodsController().reload_configuration()
+            yield
+
+        finally:
+            pass
+
+    # Reload configuration after exiting the context so that the original settings take effect.
+    IrodsController().reload_configuration()
+
+
 def wait_for_empty_queue(function, timeout_function=None, timeout_in_seconds=600):
     """Wait for empty delay queue and then run the provided function.
 
@@ -300,6 +330,31 @@ class TestStorageTieringPlugin(ResourceBase, unittest.TestCase):
                     finally:
                         alice_session.assert_icommand('irm -f ' + filename)
 
+    def test_put_with_physical_move_data_movement_mode(self):
+        with storage_tiering_configured():
+            with session.make_session_for_existing_admin() as admin_session:
+                filename = 'test_put_file_physical_move'
+
+                try:
+                    admin_session.assert_icommand('imeta set -R rnd0 irods::storage_tiering::data_movement_mode physical_move')
+                    admin_session.assert_icommand('imeta add -R rnd1 irods::storage_tiering::verification checksum')
+
+                    lib.create_local_testfile(filename)
+                    admin_session.assert_icommand('iput -R rnd0 ' + filename)
+                    time.sleep(5)
+
+                    invoke_storage_tiering_rule()
+                    delay_assert_icommand(admin_session, 'ils -L ' + filename, 'STDOUT_SINGLELINE', 'rnd1')
+
+                    # The replica was moved rather than copied, so it keeps its replica number.
+                    admin_session.assert_icommand('ils -l ' + filename, 'STDOUT_SINGLELINE', ' 0 rnd1')
+                    admin_session.assert_icommand_fail('ils -L ' + filename, 'STDOUT_SINGLELINE', 'rnd0')
+
+                finally:
+                    admin_session.assert_icommand('irm -f ' + filename)
+                    admin_session.assert_icommand('imeta rm -R rnd1 irods::storage_tiering::verification checksum')
+                    admin_session.assert_icommand('imeta rm -R rnd0 irods::storage_tiering::data_movement_mode physical_move')
+
     def test_put_and_get_with_preserve_replica__92(self):
         with storage_tiering_configured():
             zone_name = IrodsConfig().client_environment['irods_zone_name']
@@ -492,6 +547,35 @@ class TestStorageTieringPlugin(ResourceBase, unittest.TestCase):
                         alice_session.assert_icommand(f'irm -f {filename}')
                         admin_session.assert_icommand('imeta rm -R rnd1 irods::storage_tiering::verification checksum')
 
+    def test_checksum_on_replication_verification(self):
+        with storage_tiering_configured():
+            with session.make_session_for_existing_admin() as admin_session:
+                filename = 'test_file_checksum_on_replication'
+
+                try:
+                    admin_session.assert_icommand('imeta add -R rnd1 irods::storage_tiering::verification checksum_on_replication')
+
+                    contents = 'The checksum knows things.'
+                    admin_session.assert_icommand(['istream', '-R', 'rnd0', 'write', filename], input=contents)
+                    admin_session.assert_icommand(['ichksum', filename], 'STDOUT_SINGLELINE', 'sha2:')
+
+                    time.sleep(5)
+
+                    invoke_storage_tiering_rule()
+                    delay_assert_icommand(admin_session, f'ils -L {filename}', 'STDOUT_SINGLELINE', 'rnd1')
+
+                    # The checksum of the new replica was registered during the replication.
+                    coll_name = admin_session.home_collection
+                    stdout, err, rc = admin_session.run_icommand(
+                        ['iquest', '%s', f"select DATA_CHECKSUM where DATA_NAME = '{filename}' and COLL_NAME = '{coll_name}' and DATA_RESC_HIER like 'rnd1;%'"])
+                    self.assertEqual('sha2:gkAGWzFOSdRYKUCqHcR7lCX80mYbPYjaBkqqJYZovAI=\n', stdout)
+                    self.assertEqual('', err)
+                    self.assertEqual(0, rc)
+
+                finally:
+                    admin_session.assert_icommand(f'irm -f {filename}')
+                    admin_session.assert_icommand('imeta rm -R rnd1 irods::storage_tiering::verification checksum_on_replication')
+
 
 class TestStorageTieringPluginMultiGroup(ResourceBase, unittest.TestCase):
     def setUp(self):
@@ -609,6 +693,35 @@ class TestStorageTieringPluginMultiGroup(ResourceBase, unittest.TestCase):
                     admin_session.assert_icommand('irm -f ' + filename)
                     admin_session.assert_icommand('irm -f ' + filenameg2)
 
+    def test_put_with_concurrent_tier_transitions(self):
+        config = {"number_of_concurrent_tier_transitions": 4, "maximum_concurrent_catalog_queries": 2}
+        with storage_tiering_configured_with_options(config):
+            with session.make_session_for_existing_admin() as admin_session:
+                filename = 'test_put_file'
+                filenameg2 = 'test_put_fileg2'
+                filename_tier1 = 'test_put_file_tier1'
+
+                try:
+                    lib.create_local_testfile(filename)
+                    lib.create_local_testfile(filenameg2)
+                    lib.create_local_testfile(filename_tier1)
+
+                    admin_session.assert_icommand('iput -R rnd0 ' + filename)
+                    admin_session.assert_icommand('iput -R ufs0g2 ' + filenameg2)
+                    admin_session.assert_icommand('iput -R rnd1 ' + filename_tier1)
+
+                    # Both groups and both tiers of the first group are handled in the same pass.
+                    time.sleep(15)
+                    invoke_storage_tiering_rule()
+                    delay_assert_icommand(admin_session, 'ils -L ' + filename, 'STDOUT_SINGLELINE', 'rnd1')
+                    delay_assert_icommand(admin_session, 'ils -L ' + filenameg2, 'STDOUT_SINGLELINE', 'ufs1g2')
+                    delay_assert_icommand(admin_session, 'ils -L ' + filename_tier1, 'STDOUT_SINGLELINE', 'rnd2')
+
+                finally:
+                    admin_session.assert_icommand('irm -f ' + filename)
+                    admin_session.assert_icommand('irm -f ' + filenameg2)
+                    admin_session.assert_icommand('irm -f ' + filename_tier1)
+
 class TestStorageTieringPluginCustomMetadata(ResourceBase, unittest.TestCase):
     def setUp(self):
         super(TestStorageTieringPluginCustomMetadata, self).setUp()
@@ -1080,6 +1193,39 @@ class TestStorageTieringPluginPreserveReplica(ResourceBase, unittest.TestCase):
                 finally:
                     admin_session.assert_icommand('irm -f ' + filename)
 
+    def test_eviction_budget_is_not_spent_on_preserved_replicas(self):
+        with storage_tiering_configured_with_log():
+            with session.make_session_for_existing_admin() as admin_session:
+                filenames = ['test_budget_file_0', 'test_budget_file_1']
+
+                try:
+                    admin_session.assert_icommand('imeta add -R ufs0 irods::storage_tiering::eviction_budget 1 objects')
+
+                    # The first object has the oldest access time, so it comes first in the default eviction order.
+                    lib.create_local_testfile(filenames[0])
+                    admin_session.assert_icommand('iput -R ufs0 ' + filenames[0])
+                    time.sleep(2)
+                    admin_session.assert_icommand('iput -R ufs0 ' + filenames[0] + ' ' + filenames[1])
+
+                    # stage to tier 1, only the oldest object fits in the budget
+                    time.sleep(6)
+                    invoke_storage_tiering_rule()
+                    admin_session.assert_icommand('iqstat', 'STDOUT_SINGLELINE', 'irods_policy_storage_tiering')
+                    delay_assert_icommand(admin_session, 'ils -L ' + filenames[0], 'STDOUT_SINGLELINE', 'ufs1')
+                    admin_session.assert_icommand_fail('ils -L ' + filenames[1], 'STDOUT_SINGLELINE', 'ufs1')
+
+                    # The preserved replica of the first object still violates the policy on ufs0, but it must not
+                    # spend the budget, so the second object moves on the next pass.
+                    invoke_storage_tiering_rule()
+                    admin_session.assert_icommand('iqstat', 'STDOUT_SINGLELINE', 'irods_policy_storage_tiering')
+                    delay_assert_icommand(admin_session, 'ils -L ' + filenames[1], 'STDOUT_SINGLELINE', 'ufs1')
+                    admin_session.assert_icommand('ils -L ' + filenames[0], 'STDOUT_SINGLELINE', 'ufs0')
+
+                finally:
+                    admin_session.assert_icommand('imeta rm -R ufs0 irods::storage_tiering::eviction_budget 1 objects')
+                    for filename in filenames:
+                        admin_session.assert_icommand('irm -f ' + filename)
+
     def test_preserve_replicas_works_with_restage_when_replicas_exist_in_multiple_tiers__issue_232(self):
         with storage_tiering_configured_with_log():
             with session.make_session_for_existing_admin() as admin_session:
@@ -1448,6 +1594,35 @@ class TestStorageTieringPluginObjectLimit(ResourceBase, unittest.TestCase):
                     admin_session.assert_icommand('irm -f ' + self.filename)
                     admin_session.assert_icommand('irm -f ' + self.filename2)
 
+    def test_put_and_get_limit_1_resumes_from_cursor(self):
+        with storage_tiering_configured():
+            with session.make_session_for_existing_admin() as admin_session:
+                try:
+                    admin_session.assert_icommand('imeta add -R ufs0 irods::storage_tiering::object_limit 1')
+
+                    lib.create_local_testfile(self.filename)
+
+                    admin_session.assert_icommand('iput -R ufs0 ' + self.filename)
+                    admin_session.assert_icommand('iput -R ufs0 ' + self.filename + " " + self.filename2)
+                    admin_session.assert_icommand('ils -L ', 'STDOUT_SINGLELINE', 'rods')
+
+                    # stage to tier 1, the first object moves and the cursor is left after it
+                    time.sleep(5)
+                    invoke_storage_tiering_rule()
+                    admin_session.assert_icommand('iqstat', 'STDOUT_SINGLELINE', 'irods_policy_storage_tiering')
+                    delay_assert_icommand(admin_session, 'ils -L ' + self.filename, 'STDOUT_SINGLELINE', 'ufs1')
+                    delay_assert_icommand(admin_session, 'ils -L ' + self.filename2, 'STDOUT_SINGLELINE', 'ufs0')
+                    admin_session.assert_icommand('imeta ls -R ufs0 irods::storage_tiering::violating_query_cursor',
+                                                  'STDOUT_SINGLELINE', 'irods::storage_tiering::violating_query_cursor')
+
+                    # the next pass resumes after the first object
+                    invoke_storage_tiering_rule()
+                    delay_assert_icommand(admin_session, 'ils -L ' + self.filename2, 'STDOUT_SINGLELINE', 'ufs1')
+
+                finally:
+                    admin_session.assert_icommand('irm -f ' + self.filename)
+                    admin_session.assert_icommand('irm -f ' + self.filename2)
+
     def test_put_and_get_no_limit_zero(self):
         with storage_tiering_configured():
             with session.make_session_for_existing_admin() as admin_session:
@@ -1491,6 +1666,287 @@ class TestStorageTieringPluginObjectLimit(ResourceBase, unittest.TestCase):
                     admin_session.assert_icommand('irm -f ' + self.filename)
                     admin_session.assert_icommand('irm -f ' + self.filename2)
 
+    def test_put_and_get_eviction_budget_largest_first(self):
+        with storage_tiering_configured():
+            with session.make_session_for_existing_admin() as admin_session:
+                try:
+                    admin_session.assert_icommand('imeta add -R ufs0 irods::storage_tiering::eviction_budget 1 objects')
+                    admin_session.assert_icommand('imeta add -R ufs0 irods::storage_tiering::eviction_order size')
+
+                    lib.create_local_testfile(self.filename)
+                    with open(self.filename2, 'w') as f:
+                        f.write('x' * 4096)
+
+                    admin_session.assert_icommand('iput -R ufs0 ' + self.filename)
+                    admin_session.assert_icommand('iput -R ufs0 ' + self.filename2)
+                    admin_session.assert_icommand('ils -L ', 'STDOUT_SINGLELINE', 'rods')
+
+                    # stage to tier 1, only the larger object fits in the budget
+                    time.sleep(5)
+                    invoke_storage_tiering_rule()
+                    admin_session.assert_icommand('iqstat', 'STDOUT_SINGLELINE', 'irods_policy_storage_tiering')
+                    delay_assert_icommand(admin_session, 'ils -L ' + self.filename2, 'STDOUT_SINGLELINE', 'ufs1')
+                    delay_assert_icommand(admin_session, 'ils -L ' + self.filename, 'STDOUT_SINGLELINE', 'ufs0')
+
+                finally:
+                    admin_session.assert_icommand('irm -f ' + self.filename)
+                    admin_session.assert_icommand('irm -f ' + self.filename2)
+
+
+class TestStorageTieringPluginBatchedDataMovement(ResourceBase, unittest.TestCase):
+    def setUp(self):
+        super(TestStorageTieringPluginBatchedDataMovement, self).setUp()
+        with session.make_session_for_existing_admin() as admin_session:
+            admin_session.assert_icommand('iqdel -a')
+            admin_session.assert_icommand('iadmin mkresc ufs0 unixfilesystem '+test.settings.HOSTNAME_1 +':/tmp/irods/ufs0', 'STDOUT_SINGLELINE', 'unixfilesystem')
+            admin_session.assert_icommand('iadmin mkresc ufs1 unixfilesystem '+test.settings.HOSTNAME_1 +':/tmp/irods/ufs1', 'STDOUT_SINGLELINE', 'unixfilesystem')
+
+            admin_session.assert_icommand('imeta add -R ufs0 irods::storage_tiering::group example_group 0')
+            admin_session.assert_icommand('imeta add -R ufs1 irods::storage_tiering::group example_group 1')
+
+            admin_session.assert_icommand('imeta add -R ufs0 irods::storage_tiering::time 5')
+            admin_session.assert_icommand('imeta add -R ufs0 irods::storage_tiering::minimum_delay_time_in_seconds 1')
+            admin_session.assert_icommand('imeta add -R ufs0 irods::storage_tiering::maximum_delay_time_in_seconds 2')
+
+            self.filenames = ['test_batched_put_file_{}'.format(i) for i in range(3)]
+
+    def tearDown(self):
+        super(TestStorageTieringPluginBatchedDataMovement, self).tearDown()
+        with session.make_session_for_existing_admin() as admin_session:
+            admin_session.assert_icommand('iadmin rmresc ufs0')
+            admin_session.assert_icommand('iadmin rmresc ufs1')
+            admin_session.assert_icommand('iadmin rum')
+
+    def test_put_batch_size_smaller_than_number_of_objects(self):
+        with storage_tiering_configured_with_options({"data_movement_batch_size": 2}):
+            with session.make_session_for_existing_admin() as admin_session:
+                try:
+                    lib.create_local_testfile(self.filenames[0])
+                    for filename in self.filenames:
+                        admin_session.assert_icommand(['iput', '-R', 'ufs0', self.filenames[0], filename])
+
+                    # stage to tier 1, every object should move even though they are split across delay rules
+                    time.sleep(5)
+                    invoke_storage_tiering_rule()
+                    admin_session.assert_icommand('iqstat', 'STDOUT_SINGLELINE', 'irods_policy_storage_tiering')
+                    for filename in self.filenames:
+                        delay_assert_icommand(admin_session, 'ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs1')
+                        admin_session.assert_icommand_fail('ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs0')
+
+                finally:
+                    for filename in self.filenames:
+                        admin_session.run_icommand('irm -f ' + filename)
+
+    def test_put_scheduling_page_size_smaller_than_number_of_objects(self):
+        with storage_tiering_configured_with_options({"scheduling_page_size": 2}):
+            with session.make_session_for_existing_admin() as admin_session:
+                try:
+                    lib.create_local_testfile(self.filenames[0])
+                    for filename in self.filenames:
+                        admin_session.assert_icommand(['iput', '-R', 'ufs0', self.filenames[0], filename])
+
+                    # stage to tier 1, every object should move even though the flags are set one page at a time
+                    time.sleep(5)
+                    invoke_storage_tiering_rule()
+                    admin_session.assert_icommand('iqstat', 'STDOUT_SINGLELINE', 'irods_policy_storage_tiering')
+                    for filename in self.filenames:
+                        delay_assert_icommand(admin_session, 'ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs1')
+                        admin_session.assert_icommand_fail('ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs0')
+
+                finally:
+                    for filename in self.filenames:
+                        admin_session.run_icommand('irm -f ' + filename)
+
+    def test_put_large_objects_are_moved_individually_and_record_throughput(self):
+        config = {"data_movement_batch_size": 10, "large_object_size_in_bytes": 1}
+        with storage_tiering_configured_with_options(config):
+            with session.make_session_for_existing_admin() as admin_session:
+                try:
+                    lib.create_local_testfile(self.filenames[0])
+                    for filename in self.filenames:
+                        admin_session.assert_icommand(['iput', '-R', 'ufs0', self.filenames[0], filename])
+
+                    # stage to tier 1, every object is large so each one is moved by its own delay rule
+                    time.sleep(5)
+                    invoke_storage_tiering_rule()
+                    for filename in self.filenames:
+                        delay_assert_icommand(admin_session, 'ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs1')
+                        admin_session.assert_icommand_fail('ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs0')
+
+                    # the throughput learned for the pair of resources is recorded on the source resource
+                    admin_session.assert_icommand('imeta ls -R ufs0 irods::storage_tiering::transfer_throughput', 'STDOUT_SINGLELINE', 'units: ufs1')
+
+                finally:
+                    for filename in self.filenames:
+                        admin_session.run_icommand('irm -f ' + filename)
+                    admin_session.run_icommand('imeta rmw -R ufs0 irods::storage_tiering::transfer_throughput %')
+
+    def test_put_with_access_time_index(self):
+        index_directory = tempfile.mkdtemp()
+        with storage_tiering_configured_with_options({"access_time_index_directory": index_directory}):
+            with session.make_session_for_existing_admin() as admin_session:
+                try:
+                    lib.create_local_testfile(self.filenames[0])
+                    admin_session.assert_icommand(['iput', '-R', 'ufs0', self.filenames[0], self.filenames[0]])
+
+                    # the first pass scans the whole catalog and records how far the index has been consumed
+                    time.sleep(6)
+                    invoke_storage_tiering_rule()
+                    delay_assert_icommand(admin_session, 'ils -L ' + self.filenames[0], 'STDOUT_SINGLELINE', 'ufs1')
+                    lib.delayAssert(lambda: os.path.exists(os.path.join(index_directory, 'resources', 'ufs0')))
+
+                    # later passes find the violating objects through the index
+                    for filename in self.filenames[1:]:
+                        admin_session.assert_icommand(['iput', '-R', 'ufs0', self.filenames[0], filename])
+                    self.assertTrue(os.listdir(os.path.join(index_directory, 'buckets')))
+
+                    time.sleep(6)
+                    invoke_storage_tiering_rule()
+                    for filename in self.filenames[1:]:
+                        delay_assert_icommand(admin_session, 'ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs1')
+                        admin_session.assert_icommand_fail('ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs0')
+
+                finally:
+                    for filename in self.filenames:
+                        admin_session.run_icommand('irm -f ' + filename)
+                    shutil.rmtree(index_directory, ignore_errors=True)
+
+    def test_put_with_metrics_directory(self):
+        metrics_directory = tempfile.mkdtemp()
+        with storage_tiering_configured_with_options({"metrics_directory": metrics_directory,
+                                                      "metrics_write_interval_in_seconds": 0}):
+            with session.make_session_for_existing_admin() as admin_session:
+                try:
+                    for filename in self.filenames:
+                        lib.create_local_testfile(filename)
+                        admin_session.assert_icommand(['iput', '-R', 'ufs0', filename, filename])
+
+                    time.sleep(6)
+                    invoke_storage_tiering_rule()
+                    for filename in self.filenames:
+                        delay_assert_icommand(admin_session, 'ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs1')
+
+                    prom_file = os.path.join(metrics_directory, 'storage_tiering.prom')
+                    lib.delayAssert(lambda: 'irods_storage_tiering_objects_moved_total' in open(prom_file).read())
+                    with open(prom_file) as f:
+                        contents = f.read()
+                    self.assertIn('source="ufs0",destination="ufs1"', contents)
+                    self.assertIn('irods_storage_tiering_operation_duration_seconds_bucket{operation="replication"', contents)
+
+                    rule_file = 'tiering_metrics.r'
+                    with open(rule_file, 'w') as f:
+                        f.write('{"rule-engine-instance-name": "irods_rule_engine_plugin-unified_storage_tiering-instance", '
+                                '"rule-engine-operation": "irods_policy_storage_tiering_metrics"}\n'
+                                'INPUT null\nOUTPUT ruleExecOut\n')
+                    admin_session.assert_icommand(
+                        ['irule', '-r', 'irods_rule_engine_plugin-unified_storage_tiering-instance', '-F', rule_file],
+                        'STDOUT_SINGLELINE', '"objects_moved"')
+
+                finally:
+                    for filename in self.filenames:
+                        admin_session.run_icommand('irm -f ' + filename)
+                    if os.path.exists('tiering_metrics.r'):
+                        os.remove('tiering_metrics.r')
+                    shutil.rmtree(metrics_directory, ignore_errors=True)
+
+    def test_put_with_movement_trace(self):
+        trace_directory = tempfile.mkdtemp()
+        trace_log = os.path.join(trace_directory, 'trace.log')
+        with storage_tiering_configured_with_options({"movement_trace_log_path": trace_log,
+                                                      "data_movement_batch_size": 2}):
+            with session.make_session_for_existing_admin() as admin_session:
+                try:
+                    for filename in self.filenames:
+                        lib.create_local_testfile(filename)
+                        admin_session.assert_icommand(['iput', '-R', 'ufs0', filename, filename])
+
+                    time.sleep(6)
+                    invoke_storage_tiering_rule()
+                    for filename in self.filenames:
+                        delay_assert_icommand(admin_session, 'ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs1')
+
+                    def spans_for_every_object_are_recorded():
+                        with open(trace_log) as f:
+                            spans = [json.loads(line) for line in f]
+                        metadata_spans = [s for s in spans if s['span'] == 'metadata']
+                        return len(metadata_spans) == len(self.filenames)
+                    lib.delayAssert(spans_for_every_object_are_recorded)
+
+                    with open(trace_log) as f:
+                        spans = [json.loads(line) for line in f]
+
+                    # every span of a movement carries the ID of the rule which queued it
+                    enqueued = set(s['movement_id'] for s in spans if s['span'] == 'enqueue')
+                    self.assertTrue(enqueued)
+                    for name in ['queue_wait', 'replication', 'verification', 'trim', 'metadata']:
+                        movement_ids = set(s['movement_id'] for s in spans if s['span'] == name)
+                        self.assertTrue(movement_ids)
+                        self.assertTrue(movement_ids.issubset(enqueued))
+
+                    for s in spans:
+                        self.assertFalse(s['failed'])
+                        self.assertEqual('ufs0', s['source'])
+                        self.assertEqual('ufs1', s['destination'])
+
+                finally:
+                    for filename in self.filenames:
+                        admin_session.run_icommand('irm -f ' + filename)
+                    shutil.rmtree(trace_directory, ignore_errors=True)
+
+    def test_dry_run_reports_violating_objects_without_moving_them(self):
+        candidate_directory = tempfile.mkdtemp()
+        candidate_list = os.path.join(candidate_directory, 'candidates.json')
+        with storage_tiering_configured_with_options({"dry_run_candidate_list_path": candidate_list,
+                                                      "data_movement_batch_size": 2}):
+            with session.make_session_for_existing_admin() as admin_session:
+                rule_file = 'tiering_dry_run.r'
+                try:
+                    for filename in self.filenames:
+                        lib.create_local_testfile(filename)
+                        admin_session.assert_icommand(['iput', '-R', 'ufs0', filename, filename])
+
+                    time.sleep(6)
+                    with open(rule_file, 'w') as f:
+                        f.write('{"rule-engine-instance-name": "irods_rule_engine_plugin-unified_storage_tiering-instance", '
+                                '"rule-engine-operation": "irods_policy_storage_tiering", '
+                                '"storage-tier-groups": ["example_group"], '
+                                '"dry-run": true, "write-candidate-list": true}\n'
+                                'INPUT null\nOUTPUT ruleExecOut\n')
+                    stdout, _, rc = admin_session.run_icommand(
+                        ['irule', '-r', 'irods_rule_engine_plugin-unified_storage_tiering-instance', '-F', rule_file])
+                    self.assertEqual(0, rc)
+
+                    report = json.loads(stdout)
+                    self.assertEqual(1, len(report['transitions']))
+                    transition = report['transitions'][0]
+                    self.assertEqual('ufs0', transition['source'])
+                    self.assertEqual('ufs1', transition['destination'])
+                    self.assertTrue(transition['aggregated'])
+                    self.assertEqual(len(self.filenames), transition['objects'])
+                    self.assertEqual(len(self.filenames), sum(r['objects'] for r in transition['size_distribution']))
+                    self.assertEqual(transition['bytes'], sum(r['bytes'] for r in transition['size_distribution']))
+                    self.assertEqual(2, transition['delay_rules_per_pass'])
+                    self.assertGreaterEqual(transition['expected_scheduling_seconds'], 0)
+
+                    with open(candidate_list) as f:
+                        candidates = [json.loads(line) for line in f]
+                    self.assertEqual(sorted(self.filenames), sorted(os.path.basename(c['object_path']) for c in candidates))
+
+                    # nothing is flagged, queued or moved
+                    admin_session.assert_icommand(['iqstat', '-a'], 'STDOUT', 'No delayed rules pending')
+                    for filename in self.filenames:
+                        admin_session.assert_icommand('imeta ls -d ' + filename, 'STDOUT_SINGLELINE', 'irods::access_time')
+                        admin_session.assert_icommand_fail('imeta ls -d ' + filename, 'STDOUT_SINGLELINE',
+                                                           'irods::storage_tiering::migration_scheduled')
+                        admin_session.assert_icommand('ils -L ' + filename, 'STDOUT_SINGLELINE', 'ufs0')
+
+                finally:
+                    for filename in self.filenames:
+                        admin_session.run_icommand('irm -f ' + filename)
+                    if os.path.exists(rule_file):
+                        os.remove(rule_file)
+                    shutil.rmtree(candidate_directory, ignore_errors=True)
+
 
 class TestStorageTieringMultipleQueries(ResourceBase, unittest.TestCase):
     def setUp(self):
@@ -1622,6 +2078,31 @@ class TestStorageTieringPluginRegistration(ResourceBase, unittest.TestCase):
 
                     admin_session.assert_icommand('irm -rf ' + dest_path)
 
+    def test_directory_registration_sets_access_time_on_every_data_object_in_batches(self):
+        with storage_tiering_configured_with_options({"access_time_registration_batch_size": 7}):
+            with session.make_session_for_existing_admin() as admin_session:
+                local_dir_name = '/tmp/test_directory_registration_batches_dir'
+                shutil.rmtree(local_dir_name, ignore_errors=True)
+                lib.make_deep_local_tmp_dir(local_dir_name, 3, 10, 5)
+
+                dest_path = '/tempZone/home/rods/reg_coll_batches'
+
+                try:
+                    admin_session.assert_icommand('ireg -r -R ufs0 ' + local_dir_name + ' ' + dest_path)
+
+                    subtree = "COLL_NAME = '{0}' || like '{0}/%'".format(dest_path)
+                    _, total, _ = admin_session.assert_icommand(
+                        ['iquest', '%s', "select count(DATA_ID) where " + subtree], 'STDOUT')
+                    _, stamped, _ = admin_session.assert_icommand(
+                        ['iquest', '%s', "select count(DATA_ID) where " + subtree +
+                         " and META_DATA_ATTR_NAME = 'irods::access_time'"], 'STDOUT')
+                    self.assertGreater(int(total.strip()), 7)
+                    self.assertEqual(int(total.strip()), int(stamped.strip()))
+
+                finally:
+                    admin_session.assert_icommand('irm -rf ' + dest_path)
+                    shutil.rmtree(local_dir_name, ignore_errors=True)
+
 
 class TestStorageTieringContinueInxMigration(ResourceBase, unittest.TestCase):
     def setUp(self):
@@ -2251,6 +2732,19 @@ class test_accessing_read_only_object_updates_access_time(unittest.TestCase):
         self.read_object_updates_access_time_test_impl(
             self.user1.assert_icommand, ["iget", self.object_path, "-"], "STDOUT")
 
+    def test_get_within_access_time_granularity_does_not_update_access_time(self):
+        with storage_tiering_configured_with_options({"access_time_granularity_in_seconds": 3600}):
+            access_time = get_access_time(self.user1, self.object_path)
+            self.assertNotIn("CAT_NO_ROWS_FOUND", access_time)
+
+            # Sleeping guarantees the access time would be different if it were written.
+            time.sleep(2)
+
+            self.user1.assert_icommand(["iget", self.object_path, "-"], "STDOUT")
+
+            # The stored access time is within the granularity, so it is left alone.
+            self.assertEqual(access_time, get_access_time(self.user1, self.object_path))
+
 
 class test_basic_tier_out_after_creating_single_data_object(unittest.TestCase):
     @classmethod
@@ -2528,3 +3022,9 @@ class test_accessing_object_for_write_updates_access_time(unittest.TestCase):
             new_access_time = get_access_time(self.user1, self.object_path)
             self.assertNotIn("CAT_NO_ROWS_FOUND", new_access_time)
             self.assertEqual(new_access_time, access_time)
+
+class test_coalescing_catalog_access(unittest.TestCase):
+    def test_coalesced_lookups_match_the_backend(self):
+        # The test program drives the coalescing decorator with a fake catalog and checks the results it hands out.
+        with session.make_session_for_existing_admin() as admin_session:
+            admin_session.assert_icommand(['irods_test_catalog_access'], 'STDOUT', 'all checks passed')
@@ -0,0 +1,42 @@
+#include "irods/private/storage_tiering/access_time_buffer.hpp"
+
+#include <algorithm>
+
+namespace irods {
+    access_time_buffer::access_time_buffer(std::size_t _maximum_size, std::chrono::seconds _maximum_age)
+        : maximum_size_{std::max<std::size_t>(_maximum_size, 1)}
+        , maximum_age_{_maximum_age}
+    {
+    } // ctor
+
+    auto access_time_buffer::add(const std::string& _logical_path, std::time_t _access_time) -> bool
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        const std::lock_guard lock{mutex_};
+
+        if (access_times_.empty()) {
+            oldest_ = now;
+        }
+
+        auto& access_time = access_times_[_logical_path];
+        access_time = std::max(access_time, _access_time);
+
+        return access_times_.size() >= maximum_size_ || now - oldest_ >= maximum_age_;
+    } // add
+
+    auto access_time_buffer::take() -> std::map<std::string, std::time_t>
+    {
+        const std::lock_guard lock{mutex_};
+
+        std::map<std::string, std::time_t> access_times;
+        access_times.swap(access_times_);
+        return access_times;
+    } // take
+
+    auto access_time_buffer::empty() const -> bool
+    {
+        const std::lock_guard lock{mutex_};
+        return access_times_.empty();
+    } // empty
+} // namespace irods
@@ -0,0 +1,224 @@
+#include "irods/private/storage_tiering/access_time_index.hpp"
+
+#include <irods/irods_exception.hpp>
+#include <irods/rodsErrorTable.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <fstream>
+#include <set>
+#include <string_view>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    const std::string bucket_extension{".log"};
+
+    auto parse_time(std::string_view _value) -> std::optional<std::time_t>
+    {
+        std::time_t value{};
+        const auto [end, ec] = std::from_chars(_value.data(), _value.data() + _value.size(), value);
+        if (std::errc{} != ec || _value.data() + _value.size() != end) {
+            return std::nullopt;
+        }
+
+        return value;
+    } // parse_time
+
+    void create_directories(const fs::path& _path)
+    {
+        std::error_code ec;
+        fs::create_directories(_path, ec);
+        if (ec) {
+            THROW(UNIX_FILE_MKDIR_ERR - ec.value(),
+                  fmt::format("failed to create access time index directory [{}]: {}", _path.string(), ec.message()));
+        }
+    } // create_directories
+
+    void append_to_file(const fs::path& _path, const std::string& _records)
+    {
+        const auto fd = ::open(_path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno,
+                  fmt::format("failed to open access time index file [{}]", _path.string()));
+        }
+
+        std::size_t written = 0;
+        while (written < _records.size()) {
+            const auto n = ::write(fd, _records.data() + written, _records.size() - written);
+            if (n < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+
+                const auto error = errno;
+                ::close(fd);
+                THROW(UNIX_FILE_WRITE_ERR - error,
+                      fmt::format("failed to append to access time index file [{}]", _path.string()));
+            }
+
+            written += static_cast<std::size_t>(n);
+        }
+
+        ::close(fd);
+    } // append_to_file
+} // namespace
+
+namespace irods {
+    access_time_index::access_time_index(std::filesystem::path _directory, std::chrono::seconds _bucket_size)
+        : bucket_directory_{_directory / "buckets"}
+        , state_directory_{_directory / "resources"}
+        , bucket_size_{std::max<std::time_t>(_bucket_size.count(), 1)}
+    {
+    } // ctor
+
+    void access_time_index::record(const std::map<std::string, std::time_t>& _access_times) const
+    {
+        // The records for a bucket are appended with a single write so that the records of concurrent agents are
+        // not interleaved.
+        std::map<std::time_t, std::string> records;
+        for (const auto& [lp, ts] : _access_times) {
+            // Records are delimited by newlines, so such a path can only be found through the catalog.
+            if (std::string::npos != lp.find('\n')) {
+                continue;
+            }
+
+            records[bucket_start(ts)] += fmt::format("{} {}\n", ts, lp);
+        }
+
+        if (records.empty()) {
+            return;
+        }
+
+        create_directories(bucket_directory_);
+
+        for (const auto& [start, bucket_records] : records) {
+            append_to_file(bucket_directory_ / fmt::format("{}{}", start, bucket_extension), bucket_records);
+        }
+    } // record
+
+    auto access_time_index::read(std::time_t _from, std::time_t _until) const -> std::vector<std::string>
+    {
+        std::set<std::string> logical_paths;
+
+        std::error_code ec;
+        for (fs::directory_iterator entry{bucket_directory_, ec}, end; !ec && end != entry; entry.increment(ec)) {
+            if (entry->path().extension() != bucket_extension) {
+                continue;
+            }
+
+            const auto start = parse_time(entry->path().stem().string());
+            if (!start || *start + bucket_size_ <= _from || *start >= _until) {
+                continue;
+            }
+
+            std::ifstream bucket{entry->path()};
+            std::string line;
+            while (std::getline(bucket, line)) {
+                // A record which is still being written by another agent has no separator yet and is skipped.
+                const auto separator = line.find(' ');
+                if (std::string::npos == separator) {
+                    continue;
+                }
+
+                const auto ts = parse_time(std::string_view{line}.substr(0, separator));
+                if (ts && *ts >= _from && *ts < _until) {
+                    logical_paths.insert(line.substr(separator + 1));
+                }
+            }
+        }
+
+        // A missing directory means that nothing has been recorded yet.
+        if (ec && ec != std::errc::no_such_file_or_directory) {
+            THROW(UNIX_FILE_OPENDIR_ERR - ec.value(),
+                  fmt::format("failed to read access time index directory [{}]: {}",
+                              bucket_directory_.string(),
+                              ec.message()));
+        }
+
+        return {std::begin(logical_paths), std::end(logical_paths)};
+    } // read
+
+    auto access_time_index::load_state(const std::string& _resource_name) const -> std::optional<resource_state>
+    {
+        std::ifstream file{state_directory_ / _resource_name};
+        resource_state state{};
+        if (!(file >> state.consumed_until >> state.last_full_scan)) {
+            return std::nullopt;
+        }
+
+        return state;
+    } // load_state
+
+    void access_time_index::save_state(const std::string& _resource_name, const resource_state& _state) const
+    {
+        create_directories(state_directory_);
+
+        // The state is replaced with a rename so that a reader never sees a partially written file.
+        const auto path = state_directory_ / _resource_name;
+        const auto temporary_path = fs::path{path}.concat(fmt::format(".{}", ::getpid()));
+        {
+            std::ofstream file{temporary_path, std::ios::trunc};
+            file << _state.consumed_until << ' ' << _state.last_full_scan << '\n';
+            if (!file.flush()) {
+                THROW(UNIX_FILE_WRITE_ERR,
+                      fmt::format("failed to write access time index state [{}]", temporary_path.string()));
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(temporary_path, path, ec);
+        if (ec) {
+            THROW(UNIX_FILE_RENAME_ERR - ec.value(),
+                  fmt::format("failed to save access time index state [{}]: {}", path.string(), ec.message()));
+        }
+    } // save_state
+
+    void access_time_index::prune(std::time_t _stale_before) const
+    {
+        std::optional<std::time_t> consumed_by_all;
+
+        // Pruning is best effort. Anything left behind is tried again by the next pass.
+        std::error_code ec;
+        std::error_code ignored;
+        for (fs::directory_iterator entry{state_directory_, ec}, end; !ec && end != entry; entry.increment(ec)) {
+            std::ifstream file{entry->path()};
+            resource_state state{};
+            if (!(file >> state.consumed_until >> state.last_full_scan)) {
+                continue;
+            }
+
+            // A resource which has not been scanned for this long is no longer tiered with the index. If it is
+            // again, its next pass starts with a full scan.
+            if (state.last_full_scan < _stale_before) {
+                fs::remove(entry->path(), ignored);
+                continue;
+            }
+
+            consumed_by_all = std::min(consumed_by_all.value_or(state.consumed_until), state.consumed_until);
+        }
+
+        if (!consumed_by_all) {
+            return;
+        }
+
+        for (fs::directory_iterator entry{bucket_directory_, ec}, end; !ec && end != entry; entry.increment(ec)) {
+            const auto start = parse_time(entry->path().stem().string());
+            if (entry->path().extension() == bucket_extension && start && *start + bucket_size_ <= *consumed_by_all) {
+                fs::remove(entry->path(), ignored);
+            }
+        }
+    } // prune
+
+    auto access_time_index::bucket_start(std::time_t _access_time) const noexcept -> std::time_t
+    {
+        return _access_time - _access_time % bucket_size_;
+    } // bucket_start
+} // namespace irods
@@ -0,0 +1,374 @@
+// TODO(#302): Remove this - we are in the server.
+#undef RODS_SERVER
+
+#include "irods/private/storage_tiering/catalog_access.hpp"
+
+#include "irods/private/storage_tiering/resource_topology.hpp"
+#include "irods/private/storage_tiering/utilities.hpp"
+
+#include <irods/execMyRule.h>
+#include <irods/irods_at_scope_exit.hpp>
+#include <irods/irods_configuration_keywords.hpp>
+#include <irods/irods_query.hpp>
+#include <irods/irods_version.h>
+#include <irods/modAVUMetadata.h>
+#include <irods/msParam.h>
+#include <irods/rcMisc.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <set>
+#include <thread>
+#include <utility>
+
+namespace irods {
+    auto catalog_access::data_object_metadata(RcComm* _comm,
+                                              const std::string& _logical_path,
+                                              const std::string& _attribute_name) -> avu_list
+    {
+        auto results = data_object_metadata(_comm, std::vector<std::string>{_logical_path}, _attribute_name);
+        if (const auto r = results.find(_logical_path); r != std::end(results)) {
+            return std::move(r->second);
+        }
+
+        return {};
+    } // data_object_metadata
+
+    auto catalog_access::replica_number(RcComm* _comm, const std::string& _logical_path, const std::string& _leaf_ids)
+        -> std::optional<std::string>
+    {
+        auto results = replica_numbers(_comm, std::vector<std::string>{_logical_path}, _leaf_ids);
+        if (const auto r = results.find(_logical_path); r != std::end(results)) {
+            return std::move(r->second);
+        }
+
+        return std::nullopt;
+    } // replica_number
+
+    auto catalog_access::query_rows(RcComm* _comm, const std::string& _query_string, std::uint32_t _limit)
+        -> std::vector<result_row>
+    {
+        std::vector<result_row> rows;
+        for_each_row(_comm, _query_string, _limit, {}, [&rows](const result_row& _row) {
+            rows.push_back(_row);
+            return true;
+        });
+
+        return rows;
+    } // query_rows
+
+    auto genquery_catalog_access::data_object_metadata(RcComm* _comm,
+                                                       const std::vector<std::string>& _logical_paths,
+                                                       const std::string& _attribute_name)
+        -> std::map<std::string, avu_list>
+    {
+        // The IN conditions match every pairing of the collection and data names in a chunk, so only the logical
+        // paths which were actually asked about are kept.
+        std::map<std::string, avu_list> results;
+        for (const auto& chunk : make_logical_path_query_chunks(_logical_paths)) {
+            const std::set<std::string> chunk_paths(std::begin(chunk.logical_paths), std::end(chunk.logical_paths));
+
+            const auto query_str = fmt::format("select COLL_NAME, DATA_NAME, META_DATA_ATTR_VALUE, "
+                                               "META_DATA_ATTR_UNITS where META_DATA_ATTR_NAME = '{}' and "
+                                               "COLL_NAME in ({}) and DATA_NAME in ({})",
+                                               _attribute_name,
+                                               chunk.collection_names,
+                                               chunk.data_names);
+
+            for (const auto& row : query<rcComm_t>{_comm, query_str}) {
+                auto logical_path = make_logical_path(row[0], row[1]);
+                if (chunk_paths.count(logical_path) > 0) {
+                    results[std::move(logical_path)].emplace_back(row[2], row[3]);
+                }
+            }
+        }
+
+        return results;
+    } // data_object_metadata
+
+    auto genquery_catalog_access::replica_numbers(RcComm* _comm,
+                                                  const std::vector<std::string>& _logical_paths,
+                                                  const std::string& _leaf_ids) -> std::map<std::string, std::string>
+    {
+        std::map<std::string, std::string> results;
+        for (const auto& chunk : make_logical_path_query_chunks(_logical_paths)) {
+            const std::set<std::string> chunk_paths(std::begin(chunk.logical_paths), std::end(chunk.logical_paths));
+
+            const auto query_str = fmt::format("select COLL_NAME, DATA_NAME, DATA_REPL_NUM where COLL_NAME in ({}) "
+                                               "and DATA_NAME in ({}) and DATA_RESC_ID in ({})",
+                                               chunk.collection_names,
+                                               chunk.data_names,
+                                               _leaf_ids);
+
+            for (const auto& row : query<rcComm_t>{_comm, query_str}) {
+                auto logical_path = make_logical_path(row[0], row[1]);
+                if (chunk_paths.count(logical_path) > 0) {
+                    results.try_emplace(std::move(logical_path), row[2]);
+                }
+            }
+        }
+
+        return results;
+    } // replica_numbers
+
+    auto genquery_catalog_access::set_data_object_metadata(RcComm* _comm,
+                                                           const std::string& _logical_path,
+                                                           const std::string& _attribute_name,
+                                                           const std::string& _value,
+                                                           const std::string& _units) -> int
+    {
+        modAVUMetadataInp_t set_op{"set",
+                                   "-d",
+                                   const_cast<char*>(_logical_path.c_str()),
+                                   const_cast<char*>(_attribute_name.c_str()),
+                                   const_cast<char*>(_value.c_str()),
+                                   _units.empty() ? nullptr : const_cast<char*>(_units.c_str())};
+
+        const auto free_cond_input = irods::at_scope_exit{[&set_op] { clearKeyVal(&set_op.condInput); }};
+        addKeyVal(&set_op.condInput, ADMIN_KW, "");
+
+        return rcModAVUMetadata(_comm, &set_op);
+    } // set_data_object_metadata
+
+    auto genquery_catalog_access::change_data_object_metadata_units(RcComm* _comm,
+                                                                    const std::string& _logical_path,
+                                                                    const std::string& _attribute_name,
+                                                                    const std::string& _value,
+                                                                    const std::string& _current_units,
+                                                                    const std::string& _new_units) -> int
+    {
+        // A mod removes the AVU with exactly these units and adds the new one in one transaction. It fails if there
+        // is nothing to remove, which is the case once another caller has changed the units.
+        const auto new_units = fmt::format("u:{}", _new_units);
+        const bool has_units = !_current_units.empty();
+
+        modAVUMetadataInp_t mod_op{"mod",
+                                   "-d",
+                                   const_cast<char*>(_logical_path.c_str()),
+                                   const_cast<char*>(_attribute_name.c_str()),
+                                   const_cast<char*>(_value.c_str()),
+                                   const_cast<char*>(has_units ? _current_units.c_str() : new_units.c_str()),
+                                   has_units ? const_cast<char*>(new_units.c_str()) : nullptr};
+
+        const auto free_cond_input = irods::at_scope_exit{[&mod_op] { clearKeyVal(&mod_op.condInput); }};
+        addKeyVal(&mod_op.condInput, ADMIN_KW, "");
+
+        return rcModAVUMetadata(_comm, &mod_op);
+    } // change_data_object_metadata_units
+
+    void genquery_catalog_access::for_each_row(RcComm* _comm,
+                                               const std::string& _query_string,
+                                               std::uint32_t _limit,
+                                               const std::string& _query_type,
+                                               const std::function<bool(const result_row&)>& _on_row)
+    {
+        const auto query_type =
+#if IRODS_VERSION_INTEGER < 5000090
+            query<rcComm_t>::convert_string_to_query_type(_query_type);
+#else
+            query<rcComm_t>::string_to_query_type(_query_type);
+#endif
+
+        for (const auto& row : query<rcComm_t>{_comm, _query_string, _limit, 0, query_type}) {
+            if (!_on_row(row)) {
+                return;
+            }
+        }
+    } // for_each_row
+
+    auto genquery_catalog_access::set_resource_metadata(RcComm* _comm,
+                                                        const std::string& _resource_name,
+                                                        const std::string& _attribute_name,
+                                                        const std::string& _value) -> int
+    {
+        modAVUMetadataInp_t set_op{"set",
+                                   "-R",
+                                   const_cast<char*>(_resource_name.c_str()),
+                                   const_cast<char*>(_attribute_name.c_str()),
+                                   const_cast<char*>(_value.c_str()),
+                                   nullptr};
+
+        return rcModAVUMetadata(_comm, &set_op);
+    } // set_resource_metadata
+
+    auto genquery_catalog_access::execute_rule(RcComm* _comm, const std::string& _rule_text) -> int
+    {
+        execMyRuleInp_t exec_inp{};
+        msParamArray_t* out_arr{};
+        // Capture out_arr pointer by reference because it is still nullptr at this point.
+        const auto free_inputs_and_outputs = irods::at_scope_exit{[&exec_inp, &out_arr] {
+            clearKeyVal(&exec_inp.condInput);
+
+            if (exec_inp.inpParamArray) {
+                // The second parameter with a value of 1 instructs the function to free the "inOutStruct".
+                clearMsParamArray(exec_inp.inpParamArray, 1);
+                std::free(exec_inp.inpParamArray);
+            }
+
+            if (out_arr) {
+                // The second parameter with a value of 1 instructs the function to free the "inOutStruct".
+                clearMsParamArray(out_arr, 1);
+                std::free(out_arr);
+            }
+        }};
+
+        rstrcpy(exec_inp.myRule, _rule_text.c_str(), META_STR_LEN);
+        addKeyVal(&exec_inp.condInput,
+                  irods::KW_CFG_INSTANCE_NAME,
+                  "irods_rule_engine_plugin-cpp_default_policy-instance");
+
+        return rcExecMyRule(_comm, &exec_inp, &out_arr);
+    } // execute_rule
+
+    auto genquery_catalog_access::leaf_id_list(const std::string& _resource_name) -> std::string
+    {
+        return resource_topology::instance().leaf_id_list(_resource_name);
+    } // leaf_id_list
+
+    coalescing_catalog_access::coalescing_catalog_access(std::shared_ptr<catalog_access> _backend,
+                                                         std::chrono::microseconds _window,
+                                                         std::size_t _maximum_objects)
+        : backend_{std::move(_backend)}
+        , window_{_window}
+        , maximum_objects_{std::max<std::size_t>(_maximum_objects, 1)}
+    {
+    } // ctor
+
+    template <typename Result, typename Lookup>
+    auto coalescing_catalog_access::coalesce(open_requests<Result>& _open,
+                                             const std::string& _kind,
+                                             const std::vector<std::string>& _logical_paths,
+                                             Lookup _lookup) -> std::map<std::string, Result>
+    {
+        std::shared_ptr<request<Result>> joined;
+        bool leader = false;
+        {
+            const std::lock_guard lock{mutex_};
+
+            auto& open = _open[_kind];
+            if (open && open->logical_paths.size() + _logical_paths.size() > maximum_objects_) {
+                // The full request is left to its leader.
+                open.reset();
+            }
+
+            if (!open) {
+                open = std::make_shared<request<Result>>();
+                leader = true;
+            }
+
+            joined = open;
+            joined->logical_paths.insert(
+                std::end(joined->logical_paths), std::begin(_logical_paths), std::end(_logical_paths));
+        }
+
+        if (leader) {
+            std::this_thread::sleep_for(window_);
+
+            // Once the request is closed, its list of logical paths no longer changes.
+            {
+                const std::lock_guard lock{mutex_};
+                if (const auto r = _open.find(_kind); r != std::end(_open) && r->second == joined) {
+                    _open.erase(r);
+                }
+            }
+
+            try {
+                joined->promise.set_value(_lookup(joined->logical_paths));
+            }
+            catch (...) {
+                joined->promise.set_exception(std::current_exception());
+            }
+        }
+
+        // Rethrows the error of the backend, if any, in every thread which took part.
+        const auto& results = joined->results.get();
+
+        std::map<std::string, Result> own_results;
+        for (const auto& lp : _logical_paths) {
+            if (const auto r = results.find(lp); r != std::end(results)) {
+                own_results.emplace(lp, r->second);
+            }
+        }
+
+        return own_results;
+    } // coalesce
+
+    auto coalescing_catalog_access::data_object_metadata(RcComm* _comm,
+                                                         const std::vector<std::string>& _logical_paths,
+                                                         const std::string& _attribute_name)
+        -> std::map<std::string, avu_list>
+    {
+        return coalesce(metadata_requests_, _attribute_name, _logical_paths, [&](const auto& _all_logical_paths) {
+            return backend_->data_object_metadata(_comm, _all_logical_paths, _attribute_name);
+        });
+    } // data_object_metadata
+
+    auto coalescing_catalog_access::replica_numbers(RcComm* _comm,
+                                                    const std::vector<std::string>& _logical_paths,
+                                                    const std::string& _leaf_ids) -> std::map<std::string, std::string>
+    {
+        return coalesce(replica_number_requests_, _leaf_ids, _logical_paths, [&](const auto& _all_logical_paths) {
+            return backend_->replica_numbers(_comm, _all_logical_paths, _leaf_ids);
+        });
+    } // replica_numbers
+
+    auto coalescing_catalog_access::set_data_object_metadata(RcComm* _comm,
+                                                             const std::string& _logical_path,
+                                                             const std::string& _attribute_name,
+                                                             const std::string& _value,
+                                                             const std::string& _units) -> int
+    {
+        return backend_->set_data_object_metadata(_comm, _logical_path, _attribute_name, _value, _units);
+    } // set_data_object_metadata
+
+    auto coalescing_catalog_access::change_data_object_metadata_units(RcComm* _comm,
+                                                                      const std::string& _logical_path,
+                                                                      const std::string& _attribute_name,
+                                                                      const std::string& _value,
+                                                                      const std::string& _current_units,
+                                                                      const std::string& _new_units) -> int
+    {
+        return backend_->change_data_object_metadata_units(
+            _comm, _logical_path, _attribute_name, _value, _current_units, _new_units);
+    } // change_data_object_metadata_units
+
+    void coalescing_catalog_access::for_each_row(RcComm* _comm,
+                                                 const std::string& _query_string,
+                                                 std::uint32_t _limit,
+                                                 const std::string& _query_type,
+                                                 const std::function<bool(const result_row&)>& _on_row)
+    {
+        backend_->for_each_row(_comm, _query_string, _limit, _query_type, _on_row);
+    } // for_each_row
+
+    auto coalescing_catalog_access::set_resource_metadata(RcComm* _comm,
+                                                          const std::string& _resource_name,
+                                                          const std::string& _attribute_name,
+                                                          const std::string& _value) -> int
+    {
+        return backend_->set_resource_metadata(_comm, _resource_name, _attribute_name, _value);
+    } // set_resource_metadata
+
+    auto coalescing_catalog_access::execute_rule(RcComm* _comm, const std::string& _rule_text) -> int
+    {
+        return backend_->execute_rule(_comm, _rule_text);
+    } // execute_rule
+
+    auto coalescing_catalog_access::leaf_id_list(const std::string& _resource_name) -> std::string
+    {
+        return backend_->leaf_id_list(_resource_name);
+    } // leaf_id_list
+
+    auto make_catalog_access(std::chrono::microseconds _coalescing_window) -> std::shared_ptr<catalog_access>
+    {
+        auto genquery = std::make_shared<genquery_catalog_access>();
+        if (_coalescing_window <= std::chrono::microseconds::zero()) {
+            return genquery;
+        }
+
+        return std::make_shared<coalescing_catalog_access>(std::move(genquery), _coalescing_window);
+    } // make_catalog_access
+} // namespace irods
@@ -3,6 +3,7 @@
 #include <irods/irods_server_properties.hpp>
 
 #include <fmt/format.h>
+#include <nlohmann/json.hpp>
 
 namespace irods
 {
@@ -29,84 +30,191 @@ namespace irods
 					return;
 				}
 
-				// Override defaults with configured values.
+				load(*config);
 
-				if (const auto attr = config->find("access_time_attribute"); attr != config->end()) {
-					access_time_attribute = attr->get<std::string>();
-				}
+				// Only one configuration is considered for a given instance of a REP, so just return here.
+				return;
+			}
+		}
+		catch (const boost::bad_any_cast& e) {
+			THROW(INVALID_ANY_CAST, e.what());
+		}
+		catch (const std::out_of_range& e) {
+			THROW(KEY_NOT_FOUND, e.what());
+		}
 
-				if (const auto attr = config->find("group_attribute"); attr != config->end()) {
-					group_attribute = attr->get<std::string>();
-				}
+		// No valid configuration was found for the given instance name if we reach this point, which is an error.
+		THROW(SYS_INVALID_INPUT_PARAM,
+		      fmt::format("Failed to find configuration for storage_tiering plugin [{}].", _instance_name));
+	} // storage_tiering_configuration constructor
 
-				if (const auto attr = config->find("time_attribute"); attr != config->end()) {
-					time_attribute = attr->get<std::string>();
-				}
+	storage_tiering_configuration::storage_tiering_configuration(const std::string& _instance_name,
+	                                                             const nlohmann::json& _plugin_specific_configuration)
+		: instance_name{_instance_name}
+	{
+		load(_plugin_specific_configuration);
+	} // storage_tiering_configuration constructor
 
-				if (const auto attr = config->find("query_attribute"); attr != config->end()) {
-					query_attribute = attr->get<std::string>();
-				}
+	void storage_tiering_configuration::load(const nlohmann::json& _config)
+	{
+		// Override defaults with configured values.
 
-				if (const auto attr = config->find("verification_attribute"); attr != config->end()) {
-					verification_attribute = attr->get<std::string>();
-				}
+		if (const auto attr = _config.find("access_time_attribute"); attr != _config.end()) {
+			access_time_attribute = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find("data_movement_parameters_attribute"); attr != config->end()) {
-					data_movement_parameters_attribute = attr->get<std::string>();
-				}
+		if (const auto attr = _config.find("group_attribute"); attr != _config.end()) {
+			group_attribute = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find("minimum_restage_tier"); attr != config->end()) {
-					minimum_restage_tier = attr->get<std::string>();
-				}
+		if (const auto attr = _config.find("time_attribute"); attr != _config.end()) {
+			time_attribute = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find("preserve_replicas"); attr != config->end()) {
-					preserve_replicas = attr->get<std::string>();
-				}
+		if (const auto attr = _config.find("query_attribute"); attr != _config.end()) {
+			query_attribute = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find("object_limit"); attr != config->end()) {
-					object_limit = attr->get<std::string>();
-				}
+		if (const auto attr = _config.find("verification_attribute"); attr != _config.end()) {
+			verification_attribute = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find("default_data_movement_parameters"); attr != config->end()) {
-					default_data_movement_parameters = attr->get<std::string>();
-				}
+		if (const auto attr = _config.find("data_movement_parameters_attribute"); attr != _config.end()) {
+			data_movement_parameters_attribute = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find("minimum_delay_time"); attr != config->end()) {
-					default_data_movement_parameters = attr->get<std::string>();
-				}
+		if (const auto attr = _config.find("minimum_restage_tier"); attr != _config.end()) {
+			minimum_restage_tier = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find("maximum_delay_time"); attr != config->end()) {
-					default_data_movement_parameters = attr->get<std::string>();
-				}
+		if (const auto attr = _config.find("preserve_replicas"); attr != _config.end()) {
+			preserve_replicas = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find("time_check_string"); attr != config->end()) {
-					time_check_string = attr->get<std::string>();
-				}
+		if (const auto attr = _config.find("object_limit"); attr != _config.end()) {
+			object_limit = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find("number_of_scheduling_threads"); attr != config->end()) {
-					number_of_scheduling_threads = attr->get<int>();
-				}
+		if (const auto attr = _config.find("violating_query_cursor"); attr != _config.end()) {
+			violating_query_cursor = attr->get<std::string>();
+		}
 
-				if (const auto attr = config->find(data_transfer_log_level_key); attr != config->end()) {
-					const std::string& val = attr->get_ref<const std::string&>();
-					if ("LOG_NOTICE" == val) {
-						data_transfer_log_level_value = LOG_NOTICE;
-					}
-				}
+		if (const auto attr = _config.find("eviction_budget"); attr != _config.end()) {
+			eviction_budget = attr->get<std::string>();
+		}
 
-				// Only one configuration is considered for a given instance of a REP, so just return here.
-				return;
-			}
+		if (const auto attr = _config.find("eviction_order"); attr != _config.end()) {
+			eviction_order = attr->get<std::string>();
 		}
-		catch (const boost::bad_any_cast& e) {
-			THROW(INVALID_ANY_CAST, e.what());
+
+		if (const auto attr = _config.find("data_movement_mode"); attr != _config.end()) {
+			data_movement_mode = attr->get<std::string>();
 		}
-		catch (const std::out_of_range& e) {
-			THROW(KEY_NOT_FOUND, e.what());
+
+		if (const auto attr = _config.find("transfer_throughput_attribute"); attr != _config.end()) {
+			transfer_throughput_attribute = attr->get<std::string>();
 		}
 
-		// No valid configuration was found for the given instance name if we reach this point, which is an error.
-		THROW(SYS_INVALID_INPUT_PARAM,
-		      fmt::format("Failed to find configuration for storage_tiering plugin [{}].", _instance_name));
-	} // storage_tiering_configuration constructor
+		if (const auto attr = _config.find("default_data_movement_parameters"); attr != _config.end()) {
+			default_data_movement_parameters = attr->get<std::string>();
+		}
+
+		if (const auto attr = _config.find("minimum_delay_time"); attr != _config.end()) {
+			default_data_movement_parameters = attr->get<std::string>();
+		}
+
+		if (const auto attr = _config.find("maximum_delay_time"); attr != _config.end()) {
+			default_data_movement_parameters = attr->get<std::string>();
+		}
+
+		if (const auto attr = _config.find("time_check_string"); attr != _config.end()) {
+			time_check_string = attr->get<std::string>();
+		}
+
+		if (const auto attr = _config.find("number_of_scheduling_threads"); attr != _config.end()) {
+			number_of_scheduling_threads = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("number_of_concurrent_tier_transitions"); attr != _config.end()) {
+			number_of_concurrent_tier_transitions = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("maximum_concurrent_catalog_queries"); attr != _config.end()) {
+			maximum_concurrent_catalog_queries = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("catalog_lookup_coalescing_window_in_microseconds");
+		    attr != _config.end()) {
+			catalog_lookup_coalescing_window_in_microseconds = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("data_movement_batch_size"); attr != _config.end()) {
+			data_movement_batch_size = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("scheduling_page_size"); attr != _config.end()) {
+			scheduling_page_size = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("access_time_granularity_in_seconds"); attr != _config.end()) {
+			access_time_granularity_in_seconds = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("access_time_write_behind_buffer_size"); attr != _config.end()) {
+			access_time_write_behind_buffer_size = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("access_time_write_behind_interval_in_seconds");
+		    attr != _config.end()) {
+			access_time_write_behind_interval_in_seconds = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("access_time_registration_batch_size"); attr != _config.end()) {
+			access_time_registration_batch_size = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("access_time_index_directory"); attr != _config.end()) {
+			access_time_index_directory = attr->get<std::string>();
+		}
+
+		if (const auto attr = _config.find("access_time_index_bucket_size_in_seconds"); attr != _config.end()) {
+			access_time_index_bucket_size_in_seconds = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("access_time_index_full_scan_interval_in_seconds");
+		    attr != _config.end()) {
+			access_time_index_full_scan_interval_in_seconds = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("metrics_directory"); attr != _config.end()) {
+			metrics_directory = attr->get<std::string>();
+		}
+
+		if (const auto attr = _config.find("metrics_write_interval_in_seconds"); attr != _config.end()) {
+			metrics_write_interval_in_seconds = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find("movement_trace_log_path"); attr != _config.end()) {
+			movement_trace_log_path = attr->get<std::string>();
+		}
+
+		if (const auto attr = _config.find("dry_run_candidate_list_path"); attr != _config.end()) {
+			dry_run_candidate_list_path = attr->get<std::string>();
+		}
+
+		if (const auto attr = _config.find("large_object_size_in_bytes"); attr != _config.end()) {
+			large_object_size_in_bytes = attr->get<std::int64_t>();
+		}
+
+		if (const auto attr = _config.find("maximum_transfer_threads"); attr != _config.end()) {
+			maximum_transfer_threads = attr->get<int>();
+		}
+
+		if (const auto attr = _config.find(data_transfer_log_level_key); attr != _config.end()) {
+			const std::string& val = attr->get_ref<const std::string&>();
+			if ("LOG_NOTICE" == val) {
+				data_transfer_log_level_value = LOG_NOTICE;
+			}
+		}
+	} // load
 } //namespace irods
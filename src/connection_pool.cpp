@@ -0,0 +1,149 @@
+#include "irods/private/storage_tiering/connection_pool.hpp"
+
+#include <irods/getMiscSvrInfo.h>
+#include <irods/irods_logger.hpp>
+#include <irods/rcConnect.h>
+#include <irods/rcMisc.h>
+#include <irods/rodsErrorTable.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    using log_re = irods::experimental::log::rule_engine;
+
+    auto connection_is_alive(RcComm& _comm) -> bool
+    {
+        miscSvrInfo_t* info{};
+        const auto ec = rcGetMiscSvrInfo(&_comm, &info);
+        std::free(info);
+        return ec >= 0;
+    } // connection_is_alive
+} // namespace
+
+namespace irods {
+    storage_tiering_connection_pool::connection_proxy::connection_proxy(
+        storage_tiering_connection_pool& _pool,
+        std::unique_ptr<experimental::client_connection> _conn) noexcept
+        : pool_{&_pool}
+        , conn_{std::move(_conn)}
+        , healthy_{true}
+    {
+    } // ctor
+
+    storage_tiering_connection_pool::connection_proxy::connection_proxy(connection_proxy&& _other) noexcept
+        : pool_{_other.pool_}
+        , conn_{std::move(_other.conn_)}
+        , healthy_{_other.healthy_}
+    {
+        _other.pool_ = nullptr;
+    } // move ctor
+
+    storage_tiering_connection_pool::connection_proxy::~connection_proxy()
+    {
+        if (pool_) {
+            pool_->return_connection(std::move(conn_), healthy_);
+        }
+    } // dtor
+
+    storage_tiering_connection_pool::connection_proxy::operator RcComm&() const noexcept
+    {
+        return static_cast<RcComm&>(*conn_);
+    } // operator RcComm&
+
+    void storage_tiering_connection_pool::connection_proxy::invalidate() noexcept
+    {
+        healthy_ = false;
+    } // invalidate
+
+    storage_tiering_connection_pool::storage_tiering_connection_pool(int _size, std::chrono::seconds _idle_check_interval)
+        : size_{std::max(_size, 1)}
+        , idle_check_interval_{_idle_check_interval}
+    {
+        idle_.reserve(size_);
+    } // ctor
+
+    auto storage_tiering_connection_pool::get_connection() -> connection_proxy
+    {
+        std::unique_lock lock{mutex_};
+
+        connection_returned_.wait(lock, [this] {
+            return !idle_.empty() || static_cast<int>(idle_.size()) + checked_out_ < size_;
+        });
+
+        ++checked_out_;
+
+        std::unique_ptr<experimental::client_connection> conn;
+        bool needs_health_check = false;
+
+        if (!idle_.empty()) {
+            // Reuse the most recently returned connection so that rarely used connections age out on their own.
+            auto& idle = idle_.back();
+            needs_health_check = std::chrono::steady_clock::now() - idle.returned_at > idle_check_interval_;
+            conn = std::move(idle.conn);
+            idle_.pop_back();
+        }
+
+        lock.unlock();
+
+        try {
+            if (conn && needs_health_check && !connection_is_alive(static_cast<RcComm&>(*conn))) {
+                log_re::debug("{}: replacing stale connection in storage tiering connection pool.", __func__);
+                conn.reset();
+            }
+
+            if (!conn) {
+                conn = std::make_unique<experimental::client_connection>();
+            }
+        }
+        catch (...) {
+            // The slot reserved above is no longer in use, so give it back to anyone waiting on it.
+            return_connection(nullptr, false);
+            throw;
+        }
+
+        return connection_proxy{*this, std::move(conn)};
+    } // get_connection
+
+    auto storage_tiering_connection_pool::size() const noexcept -> int
+    {
+        return size_;
+    } // size
+
+    auto storage_tiering_connection_pool::is_connection_error(int _error_code) noexcept -> bool
+    {
+        switch (getIrodsErrno(_error_code)) {
+            case SYS_HEADER_READ_LEN_ERR:
+            case SYS_HEADER_WRITE_LEN_ERR:
+            case SYS_SOCK_READ_TIMEDOUT:
+            case SYS_SOCK_READ_ERR:
+                return true;
+            default:
+                return false;
+        }
+    } // is_connection_error
+
+    void storage_tiering_connection_pool::return_connection(std::unique_ptr<experimental::client_connection> _conn,
+                                                            bool _healthy)
+    {
+        {
+            const std::lock_guard lock{mutex_};
+
+            --checked_out_;
+
+            if (_conn && _healthy) {
+                // Errors reported to a previous user of the connection are not meaningful to the next one.
+                if (auto* r_error = static_cast<RcComm&>(*_conn).rError; r_error) {
+                    freeRErrorContent(r_error);
+                }
+
+                idle_.push_back({std::move(_conn), std::chrono::steady_clock::now()});
+            }
+        }
+
+        // A broken connection is disconnected here, outside of the lock.
+        _conn.reset();
+
+        connection_returned_.notify_one();
+    } // return_connection
+} // namespace irods
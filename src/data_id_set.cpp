@@ -0,0 +1,154 @@
+#include "irods/private/storage_tiering/data_id_set.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    constexpr std::uint64_t empty_slot = 0;
+    constexpr std::size_t initial_capacity = 16;
+
+    // The finalizer of splitmix64. Data IDs are allocated sequentially, so they must be mixed before their bits are
+    // used to choose a stripe and a slot.
+    auto mix(std::uint64_t _key) noexcept -> std::uint64_t
+    {
+        _key = (_key ^ (_key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        _key = (_key ^ (_key >> 27)) * 0x94d049bb133111ebULL;
+        return _key ^ (_key >> 31);
+    } // mix
+
+    auto round_up_to_power_of_two(std::size_t _n) noexcept -> std::size_t
+    {
+        std::size_t p = 1;
+        while (p < _n) {
+            p <<= 1;
+        }
+        return p;
+    } // round_up_to_power_of_two
+
+    // Linear probing. Returns the slot holding the key, or the empty slot where it belongs.
+    auto find_slot(const std::vector<std::uint64_t>& _slots, std::uint64_t _key, std::uint64_t _hash) noexcept
+        -> std::size_t
+    {
+        const auto mask = _slots.size() - 1;
+        // The low bits of the hash choose the stripe, so the slot is chosen with the high bits.
+        auto i = static_cast<std::size_t>(_hash >> 32) & mask;
+        while (_slots[i] != empty_slot && _slots[i] != _key) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    } // find_slot
+} // namespace
+
+namespace irods {
+    data_id_set::data_id_set(std::size_t _number_of_stripes)
+        : stripe_mask_{round_up_to_power_of_two(std::max<std::size_t>(_number_of_stripes, 1)) - 1}
+        , stripes_{std::make_unique<stripe[]>(stripe_mask_ + 1)}
+    {
+    } // ctor
+
+    auto data_id_set::insert(std::uint64_t _key) -> bool
+    {
+        const auto hash = mix(_key);
+        auto [s, lock] = lock_stripe(hash);
+
+        if (empty_slot == _key) {
+            return !std::exchange(s.contains_empty_key, true);
+        }
+
+        if (s.slots.empty()) {
+            s.slots.resize(initial_capacity, empty_slot);
+        }
+
+        auto i = find_slot(s.slots, _key, hash);
+        if (s.slots[i] == _key) {
+            return false;
+        }
+
+        // Keep the load factor at or below one half so that probe sequences stay short.
+        if ((s.size + 1) * 2 > s.slots.size()) {
+            grow(s);
+            i = find_slot(s.slots, _key, hash);
+        }
+
+        s.slots[i] = _key;
+        ++s.size;
+
+        return true;
+    } // insert
+
+    auto data_id_set::contains(std::uint64_t _key) const -> bool
+    {
+        const auto hash = mix(_key);
+        auto [s, lock] = lock_stripe(hash);
+
+        if (empty_slot == _key) {
+            return s.contains_empty_key;
+        }
+
+        if (s.slots.empty()) {
+            return false;
+        }
+
+        return s.slots[find_slot(s.slots, _key, hash)] == _key;
+    } // contains
+
+    auto data_id_set::size() const -> std::size_t
+    {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i <= stripe_mask_; ++i) {
+            const std::lock_guard lock{stripes_[i].mutex};
+            n += stripes_[i].size + (stripes_[i].contains_empty_key ? 1 : 0);
+        }
+        return n;
+    } // size
+
+    auto data_id_set::memory_usage() const -> std::size_t
+    {
+        std::size_t bytes = sizeof(*this) + (stripe_mask_ + 1) * sizeof(stripe);
+        for (std::size_t i = 0; i <= stripe_mask_; ++i) {
+            const std::lock_guard lock{stripes_[i].mutex};
+            bytes += stripes_[i].slots.capacity() * sizeof(std::uint64_t);
+        }
+        return bytes;
+    } // memory_usage
+
+    auto data_id_set::contended_lock_acquisitions() const noexcept -> std::uint64_t
+    {
+        return contended_lock_acquisitions_.load();
+    } // contended_lock_acquisitions
+
+    auto data_id_set::hash_logical_path(std::string_view _logical_path) noexcept -> std::uint64_t
+    {
+        // 64-bit FNV-1a.
+        std::uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const auto c : _logical_path) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    } // hash_logical_path
+
+    auto data_id_set::lock_stripe(std::uint64_t _hash) const -> std::pair<stripe&, std::unique_lock<std::mutex>>
+    {
+        auto& s = stripes_[static_cast<std::size_t>(_hash) & stripe_mask_];
+
+        std::unique_lock lock{s.mutex, std::try_to_lock};
+        if (!lock.owns_lock()) {
+            ++contended_lock_acquisitions_;
+            lock.lock();
+        }
+
+        return {s, std::move(lock)};
+    } // lock_stripe
+
+    void data_id_set::grow(stripe& _stripe)
+    {
+        std::vector<std::uint64_t> slots(_stripe.slots.size() * 2, empty_slot);
+        for (const auto key : _stripe.slots) {
+            if (empty_slot != key) {
+                slots[find_slot(slots, key, mix(key))] = key;
+            }
+        }
+        _stripe.slots.swap(slots);
+    } // grow
+} // namespace irods
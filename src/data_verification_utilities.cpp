@@ -4,6 +4,7 @@
 #include "irods/private/storage_tiering/data_verification_utilities.hpp"
 
 #include "irods/private/storage_tiering/configuration.hpp"
+#include "irods/private/storage_tiering/resource_topology.hpp"
 
 #include <irods/dataObjChksum.h>
 #include <irods/escape_utilities.hpp>
@@ -16,6 +17,10 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <optional>
+#include <utility>
+
 extern irods::resource_manager resc_mgr;
 
 namespace {
@@ -50,46 +55,6 @@ namespace {
         return size_in_vault;
     } // get_file_size_from_filesystem
 
-    std::string get_leaf_resources_string(
-        const std::string& _resource_name) {
-        std::string leaf_id_str;
-
-        // if the resource has no children then simply return
-        irods::resource_ptr root_resc;
-        irods::error err = resc_mgr.resolve(_resource_name, root_resc);
-        if(!err.ok()) {
-            THROW(err.code(), err.result());
-        }
-
-        try {
-            std::vector<irods::resource_manager::leaf_bundle_t> leaf_bundles =
-                resc_mgr.gather_leaf_bundles_for_resc(_resource_name);
-            for(const auto & bundle : leaf_bundles) {
-                for(const auto & leaf_id : bundle) {
-                    leaf_id_str +=
-                        "'" + boost::str(boost::format("%s") % leaf_id) + "',";
-                } // for
-            } // for
-        }
-        catch( const irods::exception & _e ) {
-            throw;
-        }
-
-        // if there is no hierarchy
-        if(leaf_id_str.empty()) {
-            rodsLong_t resc_id;
-            resc_mgr.hier_to_leaf_id(_resource_name, resc_id);
-            leaf_id_str =
-                "'" + boost::str(boost::format("%s") % resc_id) + "',";
-        }
-
-        // Pop off the trailing comma to ensure a valid query.
-        leaf_id_str.pop_back();
-
-        return leaf_id_str;
-
-    } // get_leaf_resources_string
-
     void get_object_and_collection_from_path(
         const std::string& _object_path,
         std::string&       _collection_name,
@@ -106,36 +71,20 @@ namespace {
         }
     } // get_object_and_collection_from_path
 
+    // Called when the catalog has no checksum for the replica, so one is always computed. A forced checksum is
+    // computed from the replica even if the catalog already has one, and replaces it.
     std::string compute_checksum_for_resource(
         rcComm_t*          _comm,
         const std::string& _object_path,
-        const std::string& _resource_name ) {
-        // query if a checksum exists
-        std::string coll_name, obj_name;
-        get_object_and_collection_from_path(
-            _object_path,
-            coll_name,
-            obj_name);
-
-        const auto query_str =
-            fmt::format("select DATA_CHECKSUM where DATA_NAME = '{}' and COLL_NAME = '{}' and RESC_NAME = '{}'",
-                        obj_name,
-                        coll_name,
-                        _resource_name);
-        irods::query<rcComm_t> qobj(_comm, query_str, 1);
-        if(qobj.size() > 0) {
-            const auto& result = qobj.front();
-            const auto& data_checksum = result[0];
-            if(!data_checksum.empty()) {
-                return data_checksum;
-            }
-        }
-
-        // no checksum, compute one
+        const std::string& _resource_name,
+        bool               _force = false ) {
         dataObjInp_t data_obj_inp{};
         rstrcpy(data_obj_inp.objPath, _object_path.c_str(), MAX_NAME_LEN);
         addKeyVal(&data_obj_inp.condInput, RESC_NAME_KW, _resource_name.c_str());
         addKeyVal(&data_obj_inp.condInput, ADMIN_KW, "");
+        if(_force) {
+            addKeyVal(&data_obj_inp.condInput, FORCE_CHKSUM_KW, "");
+        }
 
         char* chksum{};
         const auto chksum_err = rcDataObjChksum(_comm, &data_obj_inp, &chksum);
@@ -150,117 +99,81 @@ namespace {
         return chksum;
     } // compute_checksum_for_resource
 
-    void capture_replica_attributes(
-        rcComm_t*          _comm,
-        const std::string& _object_path,
-        const std::string& _resource_name,
-        std::string&       _file_path,
-        std::string&       _data_size,
-        std::string&       _data_hierarchy,
-        std::string&       _data_checksum ) {
+    // Fetches every replica of the object with one query and picks out the replica on each of the resources by
+    // its leaf resource ID. A resource without a replica yields empty attributes.
+    auto capture_replica_attributes(
+        rcComm_t*                       _comm,
+        const std::string&              _object_path,
+        const std::vector<std::string>& _resource_names) -> std::vector<irods::replica_attributes> {
         std::string coll_name, obj_name;
         get_object_and_collection_from_path(
             _object_path,
             coll_name,
             obj_name);
-        const auto leaf_str = get_leaf_resources_string(
-                                   _resource_name);
-        const auto query_str = fmt::format("select DATA_PATH, DATA_RESC_HIER, DATA_SIZE, DATA_CHECKSUM where DATA_NAME "
-                                           "= '{}' and COLL_NAME = '{}' and DATA_RESC_ID in ({})",
-                                           obj_name,
-                                           coll_name,
-                                           leaf_str);
-        irods::query<rcComm_t> qobj{_comm, query_str, 1};
-        if(qobj.size() > 0) {
-            const auto result = qobj.front();
-            _file_path      = result[0];
-            _data_hierarchy = result[1];
-            _data_size      = result[2];
-            _data_checksum  = result[3];
+
+        auto& topology = irods::resource_topology::instance();
+        std::vector<std::shared_ptr<const irods::resource_topology::resource_entry>> leaves;
+        for(const auto& r : _resource_names) {
+            leaves.push_back(topology.find(r));
         }
-    } // capture_replica_attributes
-} // namespace
 
+        std::vector<std::optional<irods::replica_attributes>> replicas(_resource_names.size());
 
-namespace irods {
+        const auto query_str = fmt::format("select DATA_RESC_ID, DATA_PATH, DATA_RESC_HIER, DATA_SIZE, DATA_CHECKSUM "
+                                           "where DATA_NAME = '{}' and COLL_NAME = '{}'",
+                                           obj_name,
+                                           coll_name);
+        for(const auto& row : irods::query<rcComm_t>{_comm, query_str}) {
+            const auto resc_id = boost::lexical_cast<rodsLong_t>(row[0]);
+
+            for(std::size_t i = 0; i < leaves.size(); ++i) {
+                const auto& ids = leaves[i]->leaf_ids;
+                if(!replicas[i] && std::binary_search(std::begin(ids), std::end(ids), resc_id)) {
+                    replicas[i] = irods::replica_attributes{row[1], row[3], row[2], row[4]};
+                    break;
+                }
+            }
+        }
 
-    bool verify_replica_for_destination_resource(
-        rcComm_t*          _comm,
-        const std::string& _instance_name,
-        const std::string& _verification_type,
-        const std::string& _object_path,
-        const std::string& _source_resource,
-        const std::string& _destination_resource) {
+        std::vector<irods::replica_attributes> results;
+        for(auto& r : replicas) {
+            results.push_back(r.value_or(irods::replica_attributes{}));
+        }
 
-        using stcfg = irods::storage_tiering_configuration;
-        auto log_level = stcfg{_instance_name}.data_transfer_log_level_value;
+        return results;
+    } // capture_replica_attributes
 
+    void log_replica_attributes(
+        int                              _log_level,
+        const char*                      _description,
+        const irods::replica_attributes& _replica) {
         rodsLog(
-            log_level,
-            "%s - [%s] [%s] [%s] [%s]",
-            __FUNCTION__,
-            _verification_type.c_str(),
-            _object_path.c_str(),
-            _source_resource.c_str(),
-            _destination_resource.c_str());
-
+            _log_level,
+            "verify_replica - %s attributes: [%s] [%s] [%s] [%s]",
+            _description,
+            _replica.file_path.c_str(),
+            _replica.data_size.c_str(),
+            _replica.data_hierarchy.c_str(),
+            _replica.data_checksum.c_str());
+    } // log_replica_attributes
+
+    bool verify_replica(
+        rcComm_t*                  _comm,
+        int                        _log_level,
+        const std::string&         _verification_type,
+        const std::string&         _object_path,
+        const std::string&         _source_resource,
+        irods::replica_attributes& _source,
+        const std::string&         _destination_resource,
+        irods::replica_attributes& _destination) {
         try {
-            std::string source_object_path;
-            std::string source_data_size;
-            std::string source_data_hierarchy;
-            std::string source_file_path;
-            std::string source_data_checksum;
-
-            capture_replica_attributes(
-                _comm,
-                _object_path,
-                _source_resource,
-                source_file_path,
-                source_data_size,
-                source_data_hierarchy,
-                source_data_checksum );
-
-            rodsLog(
-                log_level,
-                "%s - source attributes: [%s] [%s] [%s] [%s]",
-                __FUNCTION__,
-                source_file_path.c_str(),
-                source_data_size.c_str(),
-                source_data_hierarchy.c_str(),
-                source_data_checksum.c_str());
-
-            std::string destination_object_path;
-            std::string destination_data_size;
-            std::string destination_data_hierarchy;
-            std::string destination_file_path;
-            std::string destination_data_checksum;
-
-            capture_replica_attributes(
-                _comm,
-                _object_path,
-                _destination_resource,
-                destination_file_path,
-                destination_data_size,
-                destination_data_hierarchy,
-                destination_data_checksum );
-
-            rodsLog(
-                log_level,
-                "%s - destination attributes: [%s] [%s] [%s] [%s]",
-                __FUNCTION__,
-                destination_file_path.c_str(),
-                destination_data_size.c_str(),
-                destination_data_hierarchy.c_str(),
-                destination_data_checksum.c_str());
-
-
             if(_verification_type.size() == 0 ||
                VERIFY_CATALOG == _verification_type) {
                 // default verification type is 'catalog'
                 // make sure catalog update was a success
-                if(source_data_size == destination_data_size) {
+                if(_source.data_size == _destination.data_size) {
                     rodsLog(
-                        log_level,
+                        _log_level,
                         "%s - verify catalog is a success",
                         __FUNCTION__);
                     return true;
@@ -270,12 +183,12 @@ namespace irods {
                 const auto fs_size = get_file_size_from_filesystem(
                                          _comm,
                                          _object_path,
-                                         destination_data_hierarchy,
-                                         destination_file_path);
-                const auto query_size = boost::lexical_cast<rodsLong_t>(source_data_size);
+                                         _destination.data_hierarchy,
+                                         _destination.file_path);
+                const auto query_size = boost::lexical_cast<rodsLong_t>(_source.data_size);
                 auto match = (fs_size == query_size);
                 rodsLog(
-                    log_level,
+                    _log_level,
                     "%s - verify filesystem: %d - %ld vs %ld",
                     __FUNCTION__,
                     match,
@@ -284,32 +197,35 @@ namespace irods {
 
                 return match;
             }
-            else if(VERIFY_CHECKSUM == _verification_type) {
-                if(source_data_checksum.size() == 0) {
-                    source_data_checksum = compute_checksum_for_resource(
+            else if(VERIFY_CHECKSUM == _verification_type ||
+                    VERIFY_CHECKSUM_ON_REPLICATION == _verification_type) {
+                // With checksum_on_replication both checksums are normally in the catalog by now. The replicas are
+                // only read again if the source had no checksum to verify against.
+                if(_source.data_checksum.size() == 0) {
+                    _source.data_checksum = compute_checksum_for_resource(
                                                _comm,
                                                _object_path,
                                                _source_resource);
                 }
 
-                if(destination_data_checksum.size() == 0) {
-                    destination_data_checksum = compute_checksum_for_resource(
+                if(_destination.data_checksum.size() == 0) {
+                    _destination.data_checksum = compute_checksum_for_resource(
                                                    _comm,
                                                    _object_path,
                                                    _destination_resource);
                 }
 
                 rodsLog(
-                    log_level,
+                    _log_level,
                     "%s - source checksum: [%s], destination checksum [%s]",
                     __FUNCTION__,
-                    source_data_checksum.c_str(),
-                    destination_data_checksum.c_str());
+                    _source.data_checksum.c_str(),
+                    _destination.data_checksum.c_str());
 
-                auto match = (source_data_checksum == destination_data_checksum);
+                auto match = (_source.data_checksum == _destination.data_checksum);
 
                 rodsLog(
-                    log_level,
+                    _log_level,
                     "%s - verify checksum: %d",
                     __FUNCTION__,
                     match);
@@ -330,9 +246,121 @@ namespace irods {
         }
 
         return false;
+    } // verify_replica
+} // namespace
+
+
+namespace irods {
+
+    bool verify_replica_for_destination_resource(
+        rcComm_t*                            _comm,
+        const storage_tiering_configuration& _config,
+        const std::string&                   _verification_type,
+        const std::string&                   _object_path,
+        const std::string&                   _source_resource,
+        const std::string&                   _destination_resource) {
+
+        const auto log_level = _config.data_transfer_log_level_value;
+
+        rodsLog(
+            log_level,
+            "%s - [%s] [%s] [%s] [%s]",
+            __FUNCTION__,
+            _verification_type.c_str(),
+            _object_path.c_str(),
+            _source_resource.c_str(),
+            _destination_resource.c_str());
+
+        auto replicas = capture_replica_attributes(
+                            _comm,
+                            _object_path,
+                            {_source_resource, _destination_resource});
+
+        log_replica_attributes(log_level, "source", replicas[0]);
+        log_replica_attributes(log_level, "destination", replicas[1]);
+
+        return verify_replica(
+                   _comm,
+                   log_level,
+                   _verification_type,
+                   _object_path,
+                   _source_resource,
+                   replicas[0],
+                   _destination_resource,
+                   replicas[1]);
 
     } // verify_replica_for_destination_resource
 
+    auto capture_replica_for_physical_move(
+        rcComm_t*                            _comm,
+        const storage_tiering_configuration& _config,
+        const std::string&                   _verification_type,
+        const std::string&                   _object_path,
+        const std::string&                   _source_resource) -> replica_attributes {
+        auto source = std::move(capture_replica_attributes(_comm, _object_path, {_source_resource}).front());
+
+        log_replica_attributes(_config.data_transfer_log_level_value, "source", source);
+
+        if(source.data_checksum.empty() &&
+           (VERIFY_CHECKSUM == _verification_type || VERIFY_CHECKSUM_ON_REPLICATION == _verification_type)) {
+            source.data_checksum = compute_checksum_for_resource(
+                                       _comm,
+                                       _object_path,
+                                       _source_resource);
+        }
+
+        return source;
+    } // capture_replica_for_physical_move
+
+    bool verify_physically_moved_replica(
+        rcComm_t*                            _comm,
+        const storage_tiering_configuration& _config,
+        const std::string&                   _verification_type,
+        const std::string&                   _object_path,
+        const replica_attributes&            _source,
+        const std::string&                   _destination_resource) {
+        const auto log_level = _config.data_transfer_log_level_value;
+
+        rodsLog(
+            log_level,
+            "%s - [%s] [%s] [%s]",
+            __FUNCTION__,
+            _verification_type.c_str(),
+            _object_path.c_str(),
+            _destination_resource.c_str());
+
+        auto source = _source;
+        auto destination = std::move(capture_replica_attributes(_comm, _object_path, {_destination_resource}).front());
+
+        // A physical move updates the replica in place, so the destination replica inherits the size and checksum
+        // recorded for the source replica. Comparing the catalog would always succeed, so the size of the file is
+        // checked instead, and the checksum is computed again from the moved file.
+        auto verification_type = _verification_type;
+        if(verification_type.empty() || VERIFY_CATALOG == verification_type) {
+            verification_type = VERIFY_FILESYSTEM;
+        }
+        else if(VERIFY_CHECKSUM == verification_type || VERIFY_CHECKSUM_ON_REPLICATION == verification_type) {
+            destination.data_checksum = compute_checksum_for_resource(
+                                            _comm,
+                                            _object_path,
+                                            _destination_resource,
+                                            true);
+        }
+
+        log_replica_attributes(log_level, "destination", destination);
+
+        // The source replica no longer exists, so its size and checksum were captured before it was moved.
+        return verify_replica(
+                   _comm,
+                   log_level,
+                   verification_type,
+                   _object_path,
+                   "",
+                   source,
+                   _destination_resource,
+                   destination);
+    } // verify_physically_moved_replica
+
 } // namespace irods
 
 
@@ -0,0 +1,203 @@
+#include "irods/private/storage_tiering/executor.hpp"
+
+#include <irods/irods_exception.hpp>
+#include <irods/rodsErrorTable.h>
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace irods {
+    executor::executor(int _size)
+        : size_{std::max(_size, 1)}
+    {
+    } // ctor
+
+    executor::~executor()
+    {
+        stop();
+    } // dtor
+
+    void executor::post(std::function<void()> _task)
+    {
+        {
+            const std::lock_guard lock{mutex_};
+
+            if (stopping_) {
+                THROW(SYS_INVALID_OPR_TYPE, "storage tiering executor has been stopped");
+            }
+
+            if (threads_.empty()) {
+                started_at_ = std::chrono::steady_clock::now();
+                threads_.reserve(size_);
+                for (int i = 0; i < size_; ++i) {
+                    threads_.emplace_back([this] { run(); });
+                }
+            }
+
+            tasks_.push_back(std::move(_task));
+        }
+
+        task_posted_.notify_one();
+    } // post
+
+    void executor::stop()
+    {
+        std::vector<std::thread> threads;
+
+        {
+            const std::lock_guard lock{mutex_};
+            stopping_ = true;
+            threads.swap(threads_);
+        }
+
+        task_posted_.notify_all();
+
+        for (auto& t : threads) {
+            t.join();
+        }
+    } // stop
+
+    auto executor::size() const noexcept -> int
+    {
+        return size_;
+    } // size
+
+    auto executor::queue_depth() const -> std::size_t
+    {
+        const std::lock_guard lock{mutex_};
+        return tasks_.size();
+    } // queue_depth
+
+    auto executor::busy_threads() const noexcept -> int
+    {
+        return busy_threads_.load();
+    } // busy_threads
+
+    auto executor::utilization() const -> double
+    {
+        std::chrono::steady_clock::time_point started_at;
+
+        {
+            const std::lock_guard lock{mutex_};
+            if (threads_.empty()) {
+                return 0.0;
+            }
+            started_at = started_at_;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - started_at).count();
+        if (elapsed <= 0) {
+            return 0.0;
+        }
+
+        return std::min(1.0, static_cast<double>(busy_nanoseconds_.load()) / (static_cast<double>(elapsed) * size_));
+    } // utilization
+
+    void executor::run()
+    {
+        while (true) {
+            std::function<void()> task;
+
+            {
+                std::unique_lock lock{mutex_};
+                task_posted_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+
+                // Queued tasks are still run after stop() is called so that no posted work is lost.
+                if (tasks_.empty()) {
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+
+            ++busy_threads_;
+            const auto start = std::chrono::steady_clock::now();
+
+            try {
+                task();
+            }
+            catch (...) {
+                // Tasks posted through a task_group report their own errors. Anything else has nowhere to go.
+            }
+
+            busy_nanoseconds_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - start).count();
+            --busy_threads_;
+        }
+    } // run
+
+    task_group::task_group(executor& _executor)
+        : executor_{_executor}
+    {
+    } // ctor
+
+    task_group::~task_group()
+    {
+        std::unique_lock lock{mutex_};
+        task_finished_.wait(lock, [this] { return 0 == pending_; });
+    } // dtor
+
+    void task_group::post(std::function<void()> _task)
+    {
+        {
+            const std::lock_guard lock{mutex_};
+            ++pending_;
+        }
+
+        try {
+            executor_.post([this, task = std::move(_task)] {
+                std::tuple<int, std::string> error;
+                bool failed = false;
+
+                try {
+                    task();
+                }
+                catch (const irods::exception& _e) {
+                    error = {_e.code(), _e.client_display_what()};
+                    failed = true;
+                }
+                catch (const std::exception& _e) {
+                    error = {SYS_INTERNAL_ERR, _e.what()};
+                    failed = true;
+                }
+
+                // Notify while holding the lock. The waiter may destroy the group as soon as it can observe
+                // that nothing is pending.
+                const std::lock_guard lock{mutex_};
+                if (failed) {
+                    errors_.push_back(std::move(error));
+                }
+                --pending_;
+                task_finished_.notify_all();
+            });
+        }
+        catch (...) {
+            const std::lock_guard lock{mutex_};
+            --pending_;
+            throw;
+        }
+    } // post
+
+    auto task_group::wait() -> errors_type
+    {
+        std::unique_lock lock{mutex_};
+        task_finished_.wait(lock, [this] { return 0 == pending_; });
+        return std::exchange(errors_, {});
+    } // wait
+
+    storage_tiering_executors::storage_tiering_executors(int _number_of_scheduling_threads,
+                                                         int _number_of_transition_threads)
+        : transitions{_number_of_transition_threads}
+        , scheduling{_number_of_scheduling_threads}
+    {
+    } // ctor
+
+    void storage_tiering_executors::stop()
+    {
+        transitions.stop();
+        scheduling.stop();
+    } // stop
+} // namespace irods
@@ -1,10 +1,17 @@
+#include "irods/private/storage_tiering/access_time_buffer.hpp"
+#include "irods/private/storage_tiering/access_time_index.hpp"
+#include "irods/private/storage_tiering/connection_pool.hpp"
 #include "irods/private/storage_tiering/data_verification_utilities.hpp"
+#include "irods/private/storage_tiering/executor.hpp"
+#include "irods/private/storage_tiering/metrics.hpp"
+#include "irods/private/storage_tiering/movement_trace.hpp"
 #include "irods/private/storage_tiering/storage_tiering.hpp"
+#include "irods/private/storage_tiering/transfer_estimate.hpp"
 #include "irods/private/storage_tiering/utilities.hpp"
 
 #include <irods/apiNumber.h>
-#include <irods/client_connection.hpp>
-#include <irods/closeCollection.h>
+#include <irods/atomic_apply_metadata_operations.h>
+#include <irods/dataObjPhymv.h>
 #include <irods/dataObjRepl.h>
 #include <irods/dataObjTrim.h>
 #include <irods/escape_utilities.hpp>
@@ -18,10 +25,8 @@
 #include <irods/irods_server_api_call.hpp>
 #include <irods/irods_virtual_path.hpp>
 #include <irods/modAVUMetadata.h>
-#include <irods/openCollection.h>
 #include <irods/physPath.hpp>
 #include <irods/rcMisc.h>
-#include <irods/readCollection.h>
 
 #define IRODS_FILESYSTEM_ENABLE_SERVER_SIDE_API
 #include <irods/filesystem.hpp>
@@ -30,16 +35,27 @@
 
 // =-=-=-=-=-=-=-
 // stl includes
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <vector>
 #include <string>
+#include <utility>
 
 // =-=-=-=-=-=-=-
 // boost includes
 #include <boost/any.hpp>
 #include <boost/exception/all.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
 
 #include <nlohmann/json.hpp>
@@ -56,41 +72,131 @@ int _delayExec(
 namespace {
     using log_re = irods::experimental::log::rule_engine;
 
-    std::unique_ptr<irods::storage_tiering_configuration> config;
-    std::map<int, std::tuple<std::string, std::string>> opened_objects;
+    // The plugin configuration is parsed once and shared by every consumer. Readers take a reference to the current
+    // snapshot, so a reload never changes the configuration out from under work which is already in progress.
+    std::mutex configuration_mutex;
+    std::shared_ptr<const irods::storage_tiering_configuration> current_configuration;
+    std::shared_ptr<irods::storage_tiering_connection_pool> connection_pool;
+    std::unique_ptr<irods::access_time_buffer> access_time_updates;
+
+    // The data movement mode which moves a replica with a single physical move instead of replicating and trimming.
+    const std::string physical_move_mode{"physical_move"};
+    // Created by start() and drained by stop(), so the threads are shared by every tiering pass in the process.
+    std::shared_ptr<irods::storage_tiering_executors> executors;
+
+    // The logical path and root resource of each data object opened by this agent, indexed by L1 descriptor. A
+    // data object which was created rather than opened gets an access time when it is closed, but is not restaged.
+    struct opened_object {
+        std::string object_path;
+        std::string resource_name;
+        bool created;
+    };
+    std::array<std::optional<opened_object>, NUM_L1_DESC> opened_objects;
+
     std::string plugin_instance_name{};
 
-    std::tuple<int, std::string>
-    get_index_and_resource(const dataObjInp_t* _inp) {
-        int l1_idx{};
-        dataObjInfo_t* obj_info{};
-        for(const auto& l1 : L1desc) {
-            if(FD_INUSE != l1.inuseFlag) {
-                continue;
-            }
-            if(!strcmp(l1.dataObjInp->objPath, _inp->objPath)) {
-                obj_info = l1.dataObjInfo;
+    auto get_configuration() -> std::shared_ptr<const irods::storage_tiering_configuration>
+    {
+        const std::lock_guard lock{configuration_mutex};
+        return current_configuration;
+    } // get_configuration
+
+    void reload_configuration()
+    {
+        // Parse outside of the lock so that readers are never held up by the server properties.
+        auto configuration = std::make_shared<const irods::storage_tiering_configuration>(plugin_instance_name);
+
+        const std::lock_guard lock{configuration_mutex};
+        current_configuration = std::move(configuration);
+    } // reload_configuration
+
+    void record_opened_object(const std::string& _rn, std::list<boost::any>& _args)
+    {
+        if ("pep_api_data_obj_open_post" != _rn && "pep_api_data_obj_create_post" != _rn &&
+            "pep_api_replica_open_post" != _rn)
+        {
+            return;
+        }
+
+        auto it = _args.begin();
+        std::advance(it, 2);
+        if (_args.end() == it) {
+            THROW(SYS_INVALID_INPUT_PARAM, "invalid number of arguments");
+        }
+
+        const dataObjInp_t* obj_inp{};
+        try {
+            obj_inp = boost::any_cast<dataObjInp_t*>(*it);
+        }
+        catch (const boost::bad_any_cast&) {
+            // do nothing - no object to track
+            return;
+        }
+
+        // The post-PEPs do not receive the L1 descriptor returned by the API, so it has to be found by path. This
+        // happens once per open and the result is shared by the access time and restage policies.
+        int l1_idx = -1;
+        for (const auto& l1 : L1desc) {
+            if (FD_INUSE == l1.inuseFlag && !strcmp(l1.dataObjInp->objPath, obj_inp->objPath)) {
                 l1_idx = &l1 - L1desc;
             }
         }
 
-        if(nullptr == obj_info) {
-            THROW(
-                SYS_INVALID_INPUT_PARAM,
-                "no object found");
+        if (l1_idx < 0) {
+            rodsLog(LOG_ERROR, "%s: no open L1 descriptor found for [%s]", __func__, obj_inp->objPath);
+            return;
         }
 
         std::string resource_name;
-        irods::error err = irods::get_resource_property<std::string>(
-                               obj_info->rescId,
-                               irods::RESOURCE_NAME,
-                               resource_name);
-        if(!err.ok()) {
-            THROW(err.code(), err.result());
+        if (const auto err = irods::get_resource_property<std::string>(
+                L1desc[l1_idx].dataObjInfo->rescId, irods::RESOURCE_NAME, resource_name);
+            !err.ok())
+        {
+            rodsLog(LOG_ERROR, "%s: failed to get resource name for [%s]", __func__, obj_inp->objPath);
+            return;
         }
 
-        return std::make_tuple(l1_idx, resource_name);
-    } // get_index_and_resource
+        opened_objects[l1_idx] =
+            opened_object{obj_inp->objPath, std::move(resource_name), "pep_api_data_obj_create_post" == _rn};
+    } // record_opened_object
+
+    auto find_opened_object(int _l1_idx) -> const opened_object*
+    {
+        if (_l1_idx < 0 || _l1_idx >= static_cast<int>(opened_objects.size()) || !opened_objects[_l1_idx]) {
+            return nullptr;
+        }
+
+        return &*opened_objects[_l1_idx];
+    } // find_opened_object
+
+    void forget_closed_object(const std::string& _rn, std::list<boost::any>& _args) noexcept
+    {
+        try {
+            auto it = _args.begin();
+            std::advance(it, 2);
+            if (_args.end() == it) {
+                return;
+            }
+
+            int l1_idx = -1;
+            if ("pep_api_data_obj_close_post" == _rn) {
+                l1_idx = boost::any_cast<openedDataObjInp_t*>(*it)->l1descInx;
+            }
+            else if ("pep_api_replica_close_post" == _rn) {
+                const auto* inp = boost::any_cast<BytesBuf*>(*it);
+                l1_idx = nlohmann::json::parse(std::string_view(static_cast<char*>(inp->buf), inp->len))
+                             .at("fd")
+                             .get<int>();
+            }
+
+            if (l1_idx >= 0 && l1_idx < static_cast<int>(opened_objects.size())) {
+                opened_objects[l1_idx].reset();
+            }
+        }
+        catch (...) {
+            // The descriptor is simply overwritten when it is next opened.
+        }
+    } // forget_closed_object
 
     auto resource_hierarchy_has_good_replica(RcComm* _comm,
                                              const std::string& _object_path,
@@ -111,15 +217,111 @@ namespace {
         return query.size() > 0;
     } // resource_hierarchy_has_good_replica
 
-    void replicate_object_to_resource(
-        rcComm_t*          _comm,
-        const std::string& _instance_name,
-        const std::string& _source_resource,
-        const std::string& _destination_resource,
-        const std::string& _object_path) {
+    // Returns the size of a good replica of the data object in the resource hierarchy, or nothing if there is none.
+    auto get_replica_size_in_resource_hierarchy(RcComm* _comm,
+                                                const std::string& _object_path,
+                                                const std::string& _root_resource) -> std::optional<rodsLong_t>
+    {
+        namespace fs = irods::experimental::filesystem;
+
+        const auto object_path = fs::path{irods::single_quotes_to_hex(_object_path)};
+
+        const auto query_string = fmt::format("select DATA_SIZE where DATA_NAME = '{0}' and COLL_NAME = '{1}' and "
+                                              "DATA_RESC_HIER like '{2};%' || = '{2}' and DATA_REPL_STATUS = '1'",
+                                              object_path.object_name().c_str(),
+                                              object_path.parent_path().c_str(),
+                                              _root_resource);
+
+        const auto query = irods::query{_comm, query_string, 1};
+        if (query.size() == 0) {
+            return std::nullopt;
+        }
+
+        return boost::lexical_cast<rodsLong_t>(query.front()[0]);
+    } // get_replica_size_in_resource_hierarchy
+
+    // The transfer estimate for a pair of resources is kept in an AVU on the source resource whose units name the
+    // destination resource. Returns the estimate along with every value stored for the pair.
+    auto get_transfer_estimate(RcComm* _comm,
+                               const irods::storage_tiering_configuration& _config,
+                               const std::string& _source_resource,
+                               const std::string& _destination_resource)
+        -> std::pair<irods::transfer_estimate, std::vector<std::string>>
+    {
+        const auto query_string = fmt::format("select META_RESC_ATTR_VALUE where RESC_NAME = '{}' and "
+                                              "META_RESC_ATTR_NAME = '{}' and META_RESC_ATTR_UNITS = '{}'",
+                                              _source_resource,
+                                              _config.transfer_throughput_attribute,
+                                              _destination_resource);
+
+        std::optional<irods::transfer_estimate> estimate;
+        std::vector<std::string> stored_values;
+        for (const auto& row : irods::query{_comm, query_string}) {
+            if (!estimate) {
+                estimate = irods::transfer_estimate::from_string(row[0]);
+            }
+
+            stored_values.push_back(row[0]);
+        }
+
+        return {estimate.value_or(irods::transfer_estimate::initial(_config.maximum_transfer_threads)),
+                std::move(stored_values)};
+    } // get_transfer_estimate
+
+    void set_transfer_estimate(RcComm* _comm,
+                               const irods::storage_tiering_configuration& _config,
+                               const std::string& _source_resource,
+                               const std::string& _destination_resource,
+                               const std::vector<std::string>& _stored_values,
+                               const irods::transfer_estimate& _estimate)
+    {
+        auto operations = nlohmann::json::array();
+
+        // Every value stored for the pair is replaced, so that values left behind by data movements which updated
+        // the estimate at the same time do not accumulate.
+        for (const auto& value : _stored_values) {
+            operations.push_back({{"operation", "remove"},
+                                  {"attribute", _config.transfer_throughput_attribute},
+                                  {"value", value},
+                                  {"units", _destination_resource}});
+        }
+
+        operations.push_back({{"operation", "add"},
+                              {"attribute", _config.transfer_throughput_attribute},
+                              {"value", _estimate.to_string()},
+                              {"units", _destination_resource}});
+
+        const auto json_input = nlohmann::json{{"admin_mode", true},
+                                               {"entity_name", _source_resource},
+                                               {"entity_type", "resource"},
+                                               {"operations", operations}}.dump();
+
+        char* json_error_string{};
+        const auto free_error_string = irods::at_scope_exit{[&json_error_string] { std::free(json_error_string); }};
+
+        // Another data movement between the same resources may have updated the estimate since it was read. Both
+        // values are kept until the next update of the estimate removes them, so there is nothing to retry.
+        if (const auto ec = rc_atomic_apply_metadata_operations(_comm, json_input.c_str(), &json_error_string); ec < 0) {
+            log_re::debug("{}: transfer estimate for [{}] -> [{}] not updated [{}]",
+                          __func__,
+                          _source_resource,
+                          _destination_resource,
+                          ec);
+        }
+    } // set_transfer_estimate
+
+    // Returns the number of bytes replicated.
+    rodsLong_t replicate_object_to_resource(
+        rcComm_t*                        _comm,
+        const std::string&               _instance_name,
+        const std::string&               _source_resource,
+        const std::string&               _destination_resource,
+        const std::string&               _object_path,
+        const std::string&               _verification_type,
+        const std::optional<rodsLong_t>& _data_size) {
         // If the destination resource has a good replica of the data object, skip replication.
         if (resource_hierarchy_has_good_replica(_comm, _object_path, _destination_resource)) {
-            return;
+            return 0;
         }
 
         dataObjInp_t data_obj_inp{};
@@ -131,8 +333,36 @@ namespace {
 
         addKeyVal(&data_obj_inp.condInput, ADMIN_KW, "");
 
+        // The server computes the checksum of the new replica as it is written and fails the replication if it does
+        // not match the checksum of the source replica.
+        if (irods::VERIFY_CHECKSUM_ON_REPLICATION == _verification_type) {
+            addKeyVal(&data_obj_inp.condInput, VERIFY_CHKSUM_KW, "");
+        }
+
+        // Small objects are left to the server's defaults. Large objects are replicated with the number of parallel
+        // transfer threads learned for this pair of resources, and the observed throughput refines it.
+        const auto config = get_configuration();
+        // Delay rules queued by a tiering pass carry the size of the data object. Others have it looked up.
+        const auto data_size =
+            _data_size ? _data_size
+                       : get_replica_size_in_resource_hierarchy(_comm, _object_path, _source_resource);
+        const bool is_large = data_size && *data_size >= config->large_object_size_in_bytes;
+
+        std::optional<std::pair<irods::transfer_estimate, std::vector<std::string>>> estimate;
+        if (is_large) {
+            estimate = get_transfer_estimate(_comm, *config, _source_resource, _destination_resource);
+            data_obj_inp.numThreads = estimate->first.number_of_threads;
+            data_obj_inp.dataSize = *data_size;
+        }
+
+        const auto start_time = std::chrono::steady_clock::now();
+
         transferStat_t* trans_stat{};
-        const auto repl_err = rcDataObjRepl(_comm, &data_obj_inp);
+        const auto repl_err = [&] {
+            const irods::tiering_metrics::scoped_timer timer{
+                irods::tiering_metrics::instance().histogram(irods::tiering_metrics::operation::replication)};
+            return rcDataObjRepl(_comm, &data_obj_inp);
+        }();
         free(trans_stat);
         if(repl_err < 0) {
             THROW(repl_err,
@@ -140,8 +370,54 @@ namespace {
                 _object_path % _destination_resource);
 
         }
+
+        if (estimate) {
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+            if (elapsed.count() > 0) {
+                const auto observed = static_cast<double>(*data_size) / elapsed.count();
+                const auto next = estimate->first.update(observed, config->maximum_transfer_threads);
+
+                log_re::debug("{}: replicated [{}] bytes from [{}] to [{}] with [{}] threads at [{:.0f}] bytes per "
+                              "second, next transfer uses [{}] threads",
+                              __func__,
+                              *data_size,
+                              _source_resource,
+                              _destination_resource,
+                              estimate->first.number_of_threads,
+                              observed,
+                              next.number_of_threads);
+
+                set_transfer_estimate(_comm, *config, _source_resource, _destination_resource, estimate->second, next);
+            }
+        }
+
+        return data_size.value_or(0);
     } // replicate_object_to_resource
 
+    void physically_move_object_to_resource(
+        rcComm_t*          _comm,
+        const std::string& _source_resource,
+        const std::string& _destination_resource,
+        const std::string& _object_path) {
+        dataObjInp_t data_obj_inp{};
+        const auto free_cond_input = irods::at_scope_exit{[&data_obj_inp] { clearKeyVal(&data_obj_inp.condInput); }};
+        rstrcpy(data_obj_inp.objPath, _object_path.c_str(), MAX_NAME_LEN);
+        addKeyVal(&data_obj_inp.condInput, RESC_NAME_KW,      _source_resource.c_str());
+        addKeyVal(&data_obj_inp.condInput, DEST_RESC_NAME_KW, _destination_resource.c_str());
+        addKeyVal(&data_obj_inp.condInput, ADMIN_KW, "");
+
+        const irods::tiering_metrics::scoped_timer timer{
+            irods::tiering_metrics::instance().histogram(irods::tiering_metrics::operation::physical_move)};
+
+        if (const auto ec = rcDataObjPhymv(_comm, &data_obj_inp); ec < 0) {
+            THROW(ec,
+                  fmt::format("failed to physically move [{}] from [{}] to [{}]",
+                              _object_path,
+                              _source_resource,
+                              _destination_resource));
+        }
+    } // physically_move_object_to_resource
+
     void apply_data_retention_policy(
         rcComm_t*          _comm,
         const std::string& _instance_name,
@@ -168,6 +444,9 @@ namespace {
             "1");
         addKeyVal(&obj_inp.condInput, ADMIN_KW, "");
 
+        const irods::tiering_metrics::scoped_timer timer{
+            irods::tiering_metrics::instance().histogram(irods::tiering_metrics::operation::trim)};
+
         const auto trim_err = rcDataObjTrim(_comm, &obj_inp);
         if(trim_err < 0) {
             THROW(
@@ -181,9 +460,10 @@ namespace {
 
     void update_access_time_for_data_object(rcComm_t* _comm,
                                             const std::string& _logical_path,
-                                            const std::string& _attribute)
+                                            const std::string& _attribute,
+                                            std::time_t _access_time)
     {
-        auto ts = std::to_string(std::time(nullptr));
+        auto ts = std::to_string(_access_time);
         modAVUMetadataInp_t avuOp{
             "set",
             "-d",
@@ -203,32 +483,207 @@ namespace {
         }
     } // update_access_time_for_data_object
 
-    void apply_access_time_to_collection(rcComm_t* _comm, int _handle, const std::string& _attribute)
+    void write_access_times(rcComm_t* _comm,
+                            const std::map<std::string, std::time_t>& _access_times,
+                            const std::string& _attribute)
+    {
+        // Access times which are already within the configured granularity of the stored value are not written.
+        // The stored values are fetched for all of the updates at once rather than one data object at a time.
+        const auto config = get_configuration();
+        std::map<std::string, std::time_t> stored_access_times;
+        if (config->access_time_granularity_in_seconds > 0) {
+            std::vector<std::string> logical_paths;
+            logical_paths.reserve(_access_times.size());
+            for (const auto& [lp, ts] : _access_times) {
+                logical_paths.push_back(lp);
+            }
+
+            for (const auto& chunk : irods::make_logical_path_query_chunks(logical_paths)) {
+                const auto query_str = fmt::format("select COLL_NAME, DATA_NAME, META_DATA_ATTR_VALUE where "
+                                                   "META_DATA_ATTR_NAME = '{}' and COLL_NAME in ({}) and "
+                                                   "DATA_NAME in ({})",
+                                                   _attribute,
+                                                   chunk.collection_names,
+                                                   chunk.data_names);
+
+                for (const auto& row : irods::query{_comm, query_str}) {
+                    try {
+                        stored_access_times[irods::make_logical_path(row[0], row[1])] = std::stoll(row[2]);
+                    }
+                    catch (const std::exception&) {
+                        // An unreadable access time is simply overwritten.
+                    }
+                }
+            }
+        }
+
+        int last_error{};
+        std::size_t failures{};
+        std::map<std::string, std::time_t> written;
+        for (const auto& [lp, ts] : _access_times) {
+            if (const auto stored = stored_access_times.find(lp); stored_access_times.end() != stored) {
+                if (ts >= stored->second && ts - stored->second < config->access_time_granularity_in_seconds) {
+                    continue;
+                }
+            }
+
+            try {
+                update_access_time_for_data_object(_comm, lp, _attribute, ts);
+                written.emplace(lp, ts);
+            }
+            catch (const irods::exception& _e) {
+                ++failures;
+                last_error = _e.code();
+            }
+        }
+
+        // The index only narrows down where a tiering pass looks, so failing to update it is not an error.
+        if (!config->access_time_index_directory.empty() && !written.empty()) {
+            try {
+                irods::access_time_index{config->access_time_index_directory,
+                                         std::chrono::seconds{config->access_time_index_bucket_size_in_seconds}}
+                    .record(written);
+            }
+            catch (const irods::exception& _e) {
+                irods::log(_e);
+            }
+        }
+
+        if (failures > 0) {
+            THROW(last_error, fmt::format("{}: failed to set access time for [{}] data objects", __func__, failures));
+        }
+    } // write_access_times
+
+    void record_access_time(rcComm_t* _comm, const std::string& _logical_path, const std::string& _attribute)
+    {
+        if (access_time_updates->add(_logical_path, std::time(nullptr))) {
+            write_access_times(_comm, access_time_updates->take(), _attribute);
+        }
+    } // record_access_time
+
+    void flush_access_time_updates()
+    {
+        if (!access_time_updates || access_time_updates->empty()) {
+            return;
+        }
+
+        try {
+            auto conn = connection_pool->get_connection();
+            write_access_times(
+                &static_cast<RcComm&>(conn), access_time_updates->take(), get_configuration()->access_time_attribute);
+        }
+        catch (const irods::exception& _e) {
+            irods::log(_e);
+        }
+    } // flush_access_time_updates
+
+    // Adds what this agent has recorded to the metrics totals on this server. Unless forced, this happens at most
+    // once per metrics_write_interval_in_seconds.
+    void write_metrics(bool _force)
+    {
+        const auto config = get_configuration();
+        if (!config || config->metrics_directory.empty()) {
+            return;
+        }
+
+        try {
+            auto& metrics = irods::tiering_metrics::instance();
+            if (_force) {
+                metrics.write(config->metrics_directory);
+            }
+            else {
+                metrics.write_if_due(config->metrics_directory,
+                                     std::chrono::seconds{config->metrics_write_interval_in_seconds});
+            }
+        }
+        catch (const irods::exception& _e) {
+            irods::log(_e);
+        }
+        catch (const std::exception& _e) {
+            rodsLog(LOG_ERROR, "failed to write storage tiering metrics: %s", _e.what());
+        }
+    } // write_metrics
+
+    void apply_access_time_to_collection(rcComm_t* _comm,
+                                         const std::string& _collection,
+                                         const std::string& _attribute)
     {
-        collEnt_t* coll_ent{nullptr};
-        int err = rcReadCollection(_comm, _handle, &coll_ent);
-        while(err >= 0) {
-            if(DATA_OBJ_T == coll_ent->objType) {
-                const auto& vps = irods::get_virtual_path_separator();
-                std::string lp{coll_ent->collName};
-                lp += vps;
-                lp += coll_ent->dataName;
-                update_access_time_for_data_object(_comm, lp, _attribute);
-            }
-            else if(COLL_OBJ_T == coll_ent->objType) {
-                collInp_t coll_inp;
-                memset(&coll_inp, 0, sizeof(coll_inp));
-                rstrcpy(
-                    coll_inp.collName,
-                    coll_ent->collName,
-                    MAX_NAME_LEN);
-                int handle = rcOpenCollection(_comm, &coll_inp);
-                apply_access_time_to_collection(_comm, handle, _attribute);
-                rcCloseCollection(_comm, handle);
-            }
-
-            err = rcReadCollection(_comm, _handle, &coll_ent);
-        } // while
+        auto collection = _collection;
+        while (collection.size() > 1 && boost::ends_with(collection, "/")) {
+            collection.pop_back();
+        }
+
+        // The whole subtree is enumerated with a single query. The like condition treats '_' and '%' in the
+        // collection name as wildcards, so the results are checked against the collection name as well.
+        const auto query_str = fmt::format("select COLL_NAME, DATA_NAME where COLL_NAME = '{0}' || like '{0}/%'",
+                                           irods::single_quotes_to_hex(collection));
+        const auto is_in_subtree = [&collection](const std::string& _coll_name) {
+            return _coll_name == collection || boost::starts_with(_coll_name, collection + "/");
+        };
+
+        const auto config = get_configuration();
+        const auto access_time = std::time(nullptr);
+        const auto batch_size = static_cast<std::size_t>(std::max(config->access_time_registration_batch_size, 1));
+
+        std::atomic<std::size_t> stamped{0};
+        std::atomic<std::size_t> failed{0};
+        std::size_t submitted{0};
+
+        // Each batch is written by a scheduling thread over its own pooled connection. The size of a batch bounds
+        // the amount of catalog work done by any one thread between progress reports.
+        irods::task_group workers{executors->scheduling};
+        const auto submit = [&](std::map<std::string, std::time_t> _batch) {
+            submitted += _batch.size();
+            workers.post([&, batch = std::move(_batch)] {
+                try {
+                    auto conn = connection_pool->get_connection();
+                    write_access_times(&static_cast<RcComm&>(conn), batch, _attribute);
+                    stamped += batch.size();
+                }
+                catch (const irods::exception& _e) {
+                    failed += batch.size();
+                    irods::log(_e);
+                }
+
+                rodsLog(config->data_transfer_log_level_value,
+                        "set access time for [%lu] data objects under [%s], [%lu] failed",
+                        stamped.load(),
+                        collection.c_str(),
+                        failed.load());
+            });
+        };
+
+        std::map<std::string, std::time_t> batch;
+        for (const auto& row : irods::query{_comm, query_str}) {
+            if (!is_in_subtree(row[0])) {
+                continue;
+            }
+
+            batch.emplace(irods::make_logical_path(row[0], row[1]), access_time);
+            if (batch.size() >= batch_size) {
+                submit(std::exchange(batch, {}));
+            }
+        }
+
+        if (!batch.empty()) {
+            submit(std::move(batch));
+        }
+
+        workers.wait();
+
+        rodsLog(config->data_transfer_log_level_value,
+                "finished setting access time for [%lu] of [%lu] data objects under [%s]",
+                stamped.load(),
+                submitted,
+                collection.c_str());
+
+        if (failed > 0) {
+            THROW(SYS_INVALID_INPUT_PARAM,
+                  fmt::format("{}: failed to set access time for [{}] data objects under [{}]",
+                              __func__,
+                              failed.load(),
+                              collection));
+        }
     } // apply_access_time_to_collection
 
     void set_access_time_metadata(
@@ -236,28 +691,14 @@ namespace {
         const std::string& _object_path,
         const std::string& _collection_type,
         const std::string& _attribute) {
-        irods::experimental::client_connection conn;
+        auto conn = connection_pool->get_connection();
         RcComm& comm = static_cast<RcComm&>(conn);
         if(_collection_type.size() == 0) {
-            update_access_time_for_data_object(&comm, _object_path, _attribute);
+            record_access_time(&comm, _object_path, _attribute);
         }
         else {
             // register a collection
-            collInp_t coll_inp;
-            memset(&coll_inp, 0, sizeof(coll_inp));
-            rstrcpy(
-                coll_inp.collName,
-                _object_path.c_str(),
-                MAX_NAME_LEN);
-            int handle = rcOpenCollection(&comm, &coll_inp);
-            if(handle < 0) {
-                THROW(
-                    handle,
-                    boost::format("failed to open collection [%s]") %
-                    _object_path);
-            }
-
-            apply_access_time_to_collection(&comm, handle, _attribute);
+            apply_access_time_to_collection(&comm, _object_path, _attribute);
         }
     } // set_access_time_metadata
 
@@ -267,6 +708,8 @@ namespace {
         const std::list<boost::any>& _args) {
         namespace fs = irods::experimental::filesystem;
 
+        const auto config = get_configuration();
+
         try {
             if ("pep_api_data_obj_put_post" == _rn || "pep_api_data_obj_get_post" == _rn ||
                 "pep_api_data_obj_repl_post" == _rn || "pep_api_phy_path_reg_post" == _rn)
@@ -312,31 +755,6 @@ namespace {
 
                 set_access_time_metadata(_rei->rsComm, object_path, "", config->access_time_attribute);
             }
-            else if ("pep_api_data_obj_open_post" == _rn || "pep_api_data_obj_create_post" == _rn ||
-                     "pep_api_replica_open_post" == _rn)
-            {
-                auto it = _args.begin();
-                std::advance(it, 2);
-                if(_args.end() == it) {
-                    THROW(
-                        SYS_INVALID_INPUT_PARAM,
-                        "invalid number of arguments");
-                }
-
-                auto obj_inp = boost::any_cast<dataObjInp_t*>(*it);
-                int l1_idx{};
-                std::string resource_name;
-                try {
-                    auto [l1_idx, resource_name] = get_index_and_resource(obj_inp);
-                    opened_objects[l1_idx] = std::make_tuple(obj_inp->objPath, resource_name);
-                }
-                catch(const irods::exception& _e) {
-                    rodsLog(
-                       LOG_ERROR,
-                       "get_index_and_resource failed for [%s]",
-                       obj_inp->objPath);
-                }
-            }
             else if("pep_api_data_obj_close_post" == _rn) {
                 //TODO :: only for create/write events
                 auto it = _args.begin();
@@ -349,10 +767,8 @@ namespace {
 
                 const auto opened_inp = boost::any_cast<openedDataObjInp_t*>(*it);
                 const auto l1_idx = opened_inp->l1descInx;
-                if(opened_objects.find(l1_idx) != opened_objects.end()) {
-                    auto [object_path, resource_name] = opened_objects[l1_idx];
-
-                    set_access_time_metadata(_rei->rsComm, object_path, "", config->access_time_attribute);
+                if(const auto* opened = find_opened_object(l1_idx); opened) {
+                    set_access_time_metadata(_rei->rsComm, opened->object_path, "", config->access_time_attribute);
                 }
             }
             else if ("pep_api_replica_close_post" == _rn) {
@@ -379,10 +795,8 @@ namespace {
                 }
 
                 const auto l1_idx = json_input.at("fd").get<int>();
-                const auto opened_objects_iter = opened_objects.find(l1_idx);
-                if (opened_objects_iter != opened_objects.end()) {
-                    auto [object_path, resource_name] = std::get<1>(*opened_objects_iter);
-                    set_access_time_metadata(_rei->rsComm, object_path, "", config->access_time_attribute);
+                if (const auto* opened = find_opened_object(l1_idx); opened) {
+                    set_access_time_metadata(_rei->rsComm, opened->object_path, "", config->access_time_attribute);
                 }
             }
         } catch( const boost::bad_any_cast&) {
@@ -393,30 +807,80 @@ namespace {
         }
     } // apply_access_time_policy
 
-    int apply_data_movement_policy(
-        rcComm_t*          _comm,
-        const std::string& _instance_name,
-        const std::string& _object_path,
-        const std::string& _source_replica_number,
-        const std::string& _source_resource,
-        const std::string& _destination_resource,
-        const bool         _preserve_replicas,
-        const std::string& _verification_type) {
+    // Returns the number of bytes written to the destination resource.
+    rodsLong_t apply_data_movement_policy(
+        rcComm_t*                        _comm,
+        const irods::movement_trace&     _trace,
+        const std::string&               _instance_name,
+        const std::string&               _object_path,
+        const std::string&               _source_replica_number,
+        const std::string&               _source_resource,
+        const std::string&               _destination_resource,
+        const bool                       _preserve_replicas,
+        const std::string&               _verification_type,
+        const std::string&               _data_movement_mode,
+        const std::optional<rodsLong_t>& _data_size) {
+
+        // A replica which is not preserved can be moved in one operation, provided there is no replica in the way on
+        // the destination resource. The source replica is captured first because it will be gone afterwards.
+        if (!_preserve_replicas && physical_move_mode == _data_movement_mode &&
+            !resource_hierarchy_has_good_replica(_comm, _object_path, _destination_resource)) {
+            const auto config = get_configuration();
+            const auto source = irods::capture_replica_for_physical_move(
+                _comm, *config, _verification_type, _object_path, _source_resource);
 
-        replicate_object_to_resource(
-            _comm,
-            _instance_name,
-            _source_resource,
-            _destination_resource,
-            _object_path);
-
-        auto verified = irods::verify_replica_for_destination_resource(
-                            _comm,
-                            _instance_name,
-                            _verification_type,
-                            _object_path,
-                            _source_resource,
-                            _destination_resource);
+            {
+                const irods::movement_trace::span span{_trace, "physical_move", _object_path};
+                physically_move_object_to_resource(_comm, _source_resource, _destination_resource, _object_path);
+            }
+
+            const auto verified = [&] {
+                const irods::movement_trace::span span{_trace, "verification", _object_path};
+                const irods::tiering_metrics::scoped_timer timer{
+                    irods::tiering_metrics::instance().histogram(irods::tiering_metrics::operation::verification)};
+                return irods::verify_physically_moved_replica(
+                    _comm, *config, _verification_type, _object_path, source, _destination_resource);
+            }();
+
+            if (!verified) {
+                THROW(UNMATCHED_KEY_OR_INDEX,
+                      fmt::format("verification failed for [{}] physically moved to [{}]",
+                                  _object_path,
+                                  _destination_resource));
+            }
+
+            try {
+                return boost::lexical_cast<rodsLong_t>(source.data_size);
+            }
+            catch (const boost::bad_lexical_cast&) {
+                return 0;
+            }
+        }
+
+        const auto bytes_replicated = [&] {
+            const irods::movement_trace::span span{_trace, "replication", _object_path};
+            return replicate_object_to_resource(
+                _comm,
+                _instance_name,
+                _source_resource,
+                _destination_resource,
+                _object_path,
+                _verification_type,
+                _data_size);
+        }();
+
+        const auto verified = [&] {
+            const irods::movement_trace::span span{_trace, "verification", _object_path};
+            const irods::tiering_metrics::scoped_timer timer{
+                irods::tiering_metrics::instance().histogram(irods::tiering_metrics::operation::verification)};
+            return irods::verify_replica_for_destination_resource(
+                       _comm,
+                       *get_configuration(),
+                       _verification_type,
+                       _object_path,
+                       _source_resource,
+                       _destination_resource);
+        }();
         if(!verified) {
             THROW(
                 UNMATCHED_KEY_OR_INDEX,
@@ -425,14 +889,18 @@ namespace {
                 % _destination_resource);
         }
 
-        apply_data_retention_policy(
-                _comm,
-                _instance_name,
-                _object_path,
-                _source_resource,
-                _preserve_replicas);
+        // Nothing is trimmed when replicas are preserved, so there is no span to record.
+        if (!_preserve_replicas) {
+            const irods::movement_trace::span span{_trace, "trim", _object_path};
+            apply_data_retention_policy(
+                    _comm,
+                    _instance_name,
+                    _object_path,
+                    _source_resource,
+                    _preserve_replicas);
+        }
 
-        return 0;
+        return bytes_replicated;
     } // apply_data_movement_policy
 
     void apply_restage_movement_policy(
@@ -465,36 +933,13 @@ namespace {
                 parser.set_string(source_hier);
                 parser.first_resc(source_resource);
 
-                irods::experimental::client_connection conn;
+                auto conn = connection_pool->get_connection();
                 RcComm& comm = static_cast<RcComm&>(conn);
 
-                irods::storage_tiering st{&comm, _rei, plugin_instance_name};
+                irods::storage_tiering st{&comm, _rei, get_configuration(), connection_pool, executors};
 
                 st.migrate_object_to_minimum_restage_tier(object_path, source_resource);
             }
-            else if ("pep_api_data_obj_open_post" == _rn || "pep_api_replica_open_post" == _rn) {
-                auto it = _args.begin();
-                std::advance(it, 2);
-                if(_args.end() == it) {
-                    THROW(
-                        SYS_INVALID_INPUT_PARAM,
-                        "invalid number of arguments");
-                }
-
-                auto obj_inp = boost::any_cast<dataObjInp_t*>(*it);
-                int l1_idx{};
-                std::string resource_name;
-                try {
-                    auto [l1_idx, resource_name] = get_index_and_resource(obj_inp);
-                    opened_objects[l1_idx] = std::make_tuple(obj_inp->objPath, resource_name);
-                }
-                catch(const irods::exception& _e) {
-                    rodsLog(
-                       LOG_ERROR,
-                       "get_index_and_resource failed for [%s]",
-                       obj_inp->objPath);
-                }
-            }
             else if("pep_api_data_obj_close_post" == _rn) {
                 auto it = _args.begin();
                 std::advance(it, 2);
@@ -506,14 +951,12 @@ namespace {
 
                 const auto opened_inp = boost::any_cast<openedDataObjInp_t*>(*it);
                 const auto l1_idx = opened_inp->l1descInx;
-                if(opened_objects.find(l1_idx) != opened_objects.end()) {
-                    auto [object_path, resource_name] = opened_objects[l1_idx];
-
-                    irods::experimental::client_connection conn;
+                if(const auto* opened = find_opened_object(l1_idx); opened && !opened->created) {
+                    auto conn = connection_pool->get_connection();
                     RcComm& comm = static_cast<RcComm&>(conn);
 
-                    irods::storage_tiering st{&comm, _rei, plugin_instance_name};
-                    st.migrate_object_to_minimum_restage_tier(object_path, resource_name);
+                    irods::storage_tiering st{&comm, _rei, get_configuration(), connection_pool, executors};
+                    st.migrate_object_to_minimum_restage_tier(opened->object_path, opened->resource_name);
                 }
             }
             else if ("pep_api_replica_close_post" == _rn) {
@@ -540,15 +983,12 @@ namespace {
                 }
 
                 const auto l1_idx = json_input.at("fd").get<int>();
-                const auto opened_objects_iter = opened_objects.find(l1_idx);
-                if (opened_objects_iter != opened_objects.end()) {
-                    auto [object_path, resource_name] = std::get<1>(*opened_objects_iter);
-
-                    irods::experimental::client_connection conn;
+                if (const auto* opened = find_opened_object(l1_idx); opened && !opened->created) {
+                    auto conn = connection_pool->get_connection();
                     RcComm& comm = static_cast<RcComm&>(conn);
 
-                    irods::storage_tiering st{&comm, _rei, plugin_instance_name};
-                    st.migrate_object_to_minimum_restage_tier(object_path, resource_name);
+                    irods::storage_tiering st{&comm, _rei, get_configuration(), connection_pool, executors};
+                    st.migrate_object_to_minimum_restage_tier(opened->object_path, opened->resource_name);
                 }
             }
         }
@@ -577,29 +1017,166 @@ namespace {
         return 0;
     } // apply_tier_group_metadata_policy
 
+    // Continues the trace of the data movement which queued this rule. The time since the rule was queued is
+    // recorded as the wait in the delay queue, so it includes any earlier attempts of the rule.
+    auto make_movement_trace(const nlohmann::json& _rule_obj) -> irods::movement_trace
+    {
+        const auto config = get_configuration();
+
+        // Rules queued before data movements were traced carry no movement ID.
+        auto movement_id = _rule_obj.value("movement-id", std::string{});
+        if (movement_id.empty()) {
+            movement_id = irods::movement_trace::make_movement_id();
+        }
+
+        irods::movement_trace trace{config->movement_trace_log_path,
+                                    std::move(movement_id),
+                                    {{"group", _rule_obj.at("group-name")},
+                                     {"source", _rule_obj.at("source-resource")},
+                                     {"destination", _rule_obj.at("destination-resource")}}};
+
+        if (const auto enqueued_at = _rule_obj.find("enqueued-at");
+            enqueued_at != _rule_obj.end() && enqueued_at->is_number_integer())
+        {
+            trace.record("queue_wait",
+                         {},
+                         irods::movement_trace::from_microseconds(enqueued_at->get<std::int64_t>()),
+                         irods::movement_trace::clock_type::now());
+        }
+
+        return trace;
+    } // make_movement_trace
+
+    // Delay rules queued for restaging, or before the size was carried with them, do not have one.
+    auto get_data_size_from_rule(const nlohmann::json& _rule_obj) -> std::optional<rodsLong_t>
+    {
+        if (const auto itr = _rule_obj.find("data-size"); itr != _rule_obj.end()) {
+            return itr->get<rodsLong_t>();
+        }
+
+        return std::nullopt;
+    } // get_data_size_from_rule
+
+    void apply_data_movement_policy_to_objects(
+        rcComm_t*               _comm,
+        irods::storage_tiering& _st,
+        const nlohmann::json&   _rule_obj) {
+        const auto& group_name = _rule_obj.at("group-name").get_ref<const std::string&>();
+        const auto& source_resource = _rule_obj.at("source-resource").get_ref<const std::string&>();
+        const auto& destination_resource = _rule_obj.at("destination-resource").get_ref<const std::string&>();
+        const auto preserve_replicas = _rule_obj.at("preserve-replicas").get<bool>();
+        const auto& verification_type = _rule_obj.at("verification-type").get_ref<const std::string&>();
+        const auto data_movement_mode = _rule_obj.value("data-movement-mode", std::string{});
+        const auto& objects = _rule_obj.at("objects");
+
+        auto& counters =
+            irods::tiering_metrics::instance().transition(group_name, source_resource, destination_resource);
+
+        const auto trace = make_movement_trace(_rule_obj);
+
+        // One failed object should not hold back the rest of the batch. Failures are reported once every object
+        // has been attempted so that the delay server retries the rule according to its delay parameters.
+        std::size_t failures{};
+        int last_error{};
+        for (const auto& object : objects) {
+            const auto& object_path = object.at("object-path").get_ref<const std::string&>();
+            const auto& source_replica_number = object.at("source-replica-number").get_ref<const std::string&>();
+            const auto data_size = get_data_size_from_rule(object);
+
+            try {
+                // A retry of this rule will see objects whose replicas were already moved by an earlier attempt.
+                const bool already_moved =
+                    !preserve_replicas && !resource_hierarchy_has_good_replica(_comm, object_path, source_resource) &&
+                    resource_hierarchy_has_good_replica(_comm, object_path, destination_resource);
+
+                if (!already_moved) {
+                    const auto bytes_moved = apply_data_movement_policy(_comm,
+                                                                        trace,
+                                                                        plugin_instance_name,
+                                                                        object_path,
+                                                                        source_replica_number,
+                                                                        source_resource,
+                                                                        destination_resource,
+                                                                        preserve_replicas,
+                                                                        verification_type,
+                                                                        data_movement_mode,
+                                                                        data_size);
+
+                    ++counters.objects_moved;
+                    counters.bytes_moved += bytes_moved;
+                }
+
+                const irods::movement_trace::span span{trace, "metadata", object_path};
+                apply_tier_group_metadata_policy(
+                    _st, group_name, object_path, source_replica_number, source_resource, destination_resource);
+            }
+            catch (const irods::exception& _e) {
+                ++failures;
+                last_error = _e.code();
+                irods::log(_e);
+            }
+        }
+
+        if (failures > 0) {
+            THROW(last_error,
+                  fmt::format("data movement failed for [{}] of [{}] objects from [{}] to [{}]",
+                              failures,
+                              objects.size(),
+                              source_resource,
+                              destination_resource));
+        }
+    } // apply_data_movement_policy_to_objects
 
 } // namespace
 
 auto setup(irods::default_re_ctx&, const std::string& _instance_name) -> irods::error
 {
+    // Access times buffered before a repeated setup are written with the configuration and connections they were
+    // buffered under, before either is replaced.
+    flush_access_time_updates();
+
     plugin_instance_name = _instance_name;
     RuleExistsHelper::Instance()->registerRuleRegex("pep_api_.*");
-    config = std::make_unique<irods::storage_tiering_configuration>(plugin_instance_name);
+    reload_configuration();
+    const auto config = get_configuration();
+    // One connection for each scheduling thread plus one for the thread driving the tiering pass. Concurrent tier
+    // transitions each hold a connection of their own for the duration of the transition.
+    const auto transition_connections =
+        config->number_of_concurrent_tier_transitions > 1 ? config->number_of_concurrent_tier_transitions : 0;
+    connection_pool = std::make_shared<irods::storage_tiering_connection_pool>(
+        config->number_of_scheduling_threads + 1 + transition_connections);
+    access_time_updates = std::make_unique<irods::access_time_buffer>(
+        config->access_time_write_behind_buffer_size,
+        std::chrono::seconds{config->access_time_write_behind_interval_in_seconds});
     return SUCCESS();
 } // setup
 
 auto teardown(irods::default_re_ctx&, const std::string&) -> irods::error
 {
+    // Buffered access times are written before the agent goes away.
+    flush_access_time_updates();
     return SUCCESS();
 } // teardown
 
 auto start(irods::default_re_ctx&, const std::string&) -> irods::error
 {
+    const auto config = get_configuration();
+    executors = std::make_shared<irods::storage_tiering_executors>(
+        config->number_of_scheduling_threads, config->number_of_concurrent_tier_transitions);
     return SUCCESS();
 } // start
 
 auto stop(irods::default_re_ctx&, const std::string&) -> irods::error
 {
+    if (executors) {
+        // Work which has already been posted is finished before the threads are joined.
+        executors->stop();
+        log_re::debug("{}: scheduling thread utilization [{:.2f}]", __func__, executors->scheduling.utilization());
+        executors.reset();
+    }
+
+    flush_access_time_updates();
+    write_metrics(true);
     return SUCCESS();
 } // stop
 
@@ -640,6 +1217,9 @@ irods::error exec_rule(
     }
 
     try {
+        record_opened_object(_rn, _args);
+        const auto forget_closed = irods::at_scope_exit{[&_rn, &_args] { forget_closed_object(_rn, _args); }};
+
         apply_access_time_policy(_rn, rei, _args);
         apply_restage_movement_policy(_rn, rei, _args);
     }
@@ -727,12 +1307,53 @@ irods::error exec_rule_text(
             const auto& storage_tier_groups = rule_obj.at("storage-tier-groups").get_ref<const json::array_t&>();
             delay_obj["storage-tier-groups"] = storage_tier_groups;
 
-            irods::experimental::client_connection conn;
+            auto conn = connection_pool->get_connection();
             RcComm& comm = static_cast<RcComm&>(conn);
 
-            irods::storage_tiering st{&comm, rei, plugin_instance_name};
+            irods::storage_tiering st{&comm, rei, get_configuration(), connection_pool, executors};
             st.schedule_storage_tiering_policy(delay_obj.dump(), params);
         }
+        else if (irods::storage_tiering::policy::storage_tiering == rule_engine_operation &&
+                 rule_obj.value("dry-run", false))
+        {
+            const auto config = get_configuration();
+
+            // The candidate list is only ever written to the path configured for the plugin, not to one named in
+            // the rule.
+            std::string candidate_list_path;
+            if (rule_obj.value("write-candidate-list", false)) {
+                if (config->dry_run_candidate_list_path.empty()) {
+                    return ERROR(SYS_INVALID_INPUT_PARAM,
+                                 "write-candidate-list requires dry_run_candidate_list_path to be configured");
+                }
+
+                candidate_list_path = config->dry_run_candidate_list_path;
+            }
+
+            auto conn = connection_pool->get_connection();
+            RcComm& comm = static_cast<RcComm&>(conn);
+
+            irods::storage_tiering st{&comm, rei, config, connection_pool, executors};
+            const auto report = st.plan_policy_for_tier_groups(
+                rule_obj.at("storage-tier-groups").get<std::vector<std::string>>(), candidate_list_path);
+
+            if (const auto err = _eff_hdlr("writeLine", std::string{"stdout"}, report.dump()); !err.ok()) {
+                return err;
+            }
+        }
+        else if (irods::storage_tiering::policy::metrics == rule_engine_operation) {
+            // Without a metrics directory, only what this agent has recorded is available.
+            const auto config = get_configuration();
+            auto metrics = irods::tiering_metrics::instance().to_json();
+            if (!config->metrics_directory.empty()) {
+                write_metrics(true);
+                metrics = irods::tiering_metrics::read(config->metrics_directory);
+            }
+
+            if (const auto err = _eff_hdlr("writeLine", std::string{"stdout"}, metrics.dump()); !err.ok()) {
+                return err;
+            }
+        }
         else {
             return ERROR(
                     SYS_NOT_SUPPORTED,
@@ -788,15 +1409,40 @@ irods::error exec_rule_expression(
         }
 
         const auto& rule_engine_operation = rule_engine_operation_iter->get_ref<const std::string&>();
+
+        const bool records_metrics = irods::storage_tiering::policy::storage_tiering == rule_engine_operation ||
+                                     irods::storage_tiering::policy::data_movement == rule_engine_operation;
+        const auto write_metrics_on_exit = irods::at_scope_exit{[records_metrics] {
+            if (records_metrics) {
+                write_metrics(false);
+            }
+        }};
+
         if (irods::storage_tiering::policy::storage_tiering == rule_engine_operation) {
             try {
-                irods::experimental::client_connection conn;
+                auto conn = connection_pool->get_connection();
                 RcComm& comm = static_cast<RcComm&>(conn);
 
-                irods::storage_tiering st{&comm, rei, plugin_instance_name};
-                for (const auto& group : rule_obj.at("storage-tier-groups").get_ref<const json::array_t&>()) {
-                    st.apply_policy_for_tier_group(group);
-                }
+                irods::storage_tiering st{&comm, rei, get_configuration(), connection_pool, executors};
+                st.apply_policy_for_tier_groups(rule_obj.at("storage-tier-groups").get<std::vector<std::string>>());
+            }
+            catch(const irods::exception& _e) {
+                printErrorStack(&rei->rsComm->rError);
+                return ERROR(
+                        _e.code(),
+                        _e.what());
+            }
+        }
+        else if (irods::storage_tiering::policy::data_movement == rule_engine_operation &&
+                 rule_obj.contains("objects"))
+        {
+            try {
+                auto conn = connection_pool->get_connection();
+                RcComm& comm = static_cast<RcComm&>(conn);
+
+                irods::storage_tiering st{&comm, rei, get_configuration(), connection_pool, executors};
+
+                apply_data_movement_policy_to_objects(&comm, st, rule_obj);
             }
             catch(const irods::exception& _e) {
                 printErrorStack(&rei->rsComm->rError);
@@ -813,23 +1459,38 @@ irods::error exec_rule_expression(
                 const auto& destination_resource = rule_obj.at("destination-resource").get_ref<const std::string&>();
                 const auto preserve_replicas = rule_obj.at("preserve-replicas").get<bool>();
                 const auto& verification_type = rule_obj.at("verification-type").get_ref<const std::string&>();
+                // Rules queued before the data movement mode was introduced do not carry one.
+                const auto data_movement_mode = rule_obj.value("data-movement-mode", std::string{});
+                const auto data_size = get_data_size_from_rule(rule_obj);
+
+                const auto trace = make_movement_trace(rule_obj);
 
-                irods::experimental::client_connection conn;
+                auto conn = connection_pool->get_connection();
                 RcComm& comm = static_cast<RcComm&>(conn);
 
-                auto status = apply_data_movement_policy(&comm,
-                                                         plugin_instance_name,
-                                                         object_path,
-                                                         source_replica_number,
-                                                         source_resource,
-                                                         destination_resource,
-                                                         preserve_replicas,
-                                                         verification_type);
+                const auto bytes_moved = apply_data_movement_policy(&comm,
+                                                                    trace,
+                                                                    plugin_instance_name,
+                                                                    object_path,
+                                                                    source_replica_number,
+                                                                    source_resource,
+                                                                    destination_resource,
+                                                                    preserve_replicas,
+                                                                    verification_type,
+                                                                    data_movement_mode,
+                                                                    data_size);
 
-                irods::storage_tiering st{&comm, rei, plugin_instance_name};
+                irods::storage_tiering st{&comm, rei, get_configuration(), connection_pool, executors};
 
                 const auto& group_name = rule_obj.at("group-name").get_ref<const std::string&>();
-                status = apply_tier_group_metadata_policy(
+
+                auto& counters =
+                    irods::tiering_metrics::instance().transition(group_name, source_resource, destination_resource);
+                ++counters.objects_moved;
+                counters.bytes_moved += bytes_moved;
+
+                const irods::movement_trace::span span{trace, "metadata", object_path};
+                apply_tier_group_metadata_policy(
                     st, group_name, object_path, source_replica_number, source_resource, destination_resource);
             }
             catch(const irods::exception& _e) {
@@ -0,0 +1,356 @@
+#include "irods/private/storage_tiering/metrics.hpp"
+
+#include <irods/irods_at_scope_exit.hpp>
+#include <irods/irods_exception.hpp>
+#include <irods/rodsErrorTable.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    using operation = irods::tiering_metrics::operation;
+
+    const std::string totals_file_name{"storage_tiering_metrics.json"};
+    const std::string lock_file_name{"storage_tiering_metrics.lock"};
+    const std::string prometheus_file_name{"storage_tiering.prom"};
+
+    const std::array<std::pair<operation, const char*>, 5> operation_names{{
+        {operation::queue_data_movement, "queue_data_movement"},
+        {operation::replication, "replication"},
+        {operation::physical_move, "physical_move"},
+        {operation::verification, "verification"},
+        {operation::trim, "trim"},
+    }};
+
+    // The counters of a transition, in the order they are written.
+    const std::array<std::pair<const char*, const char*>, 5> counter_names{{
+        {"objects_scanned", "Violating data objects read from the violating queries."},
+        {"objects_skipped", "Violating data objects which were already scheduled or already in a lower tier."},
+        {"objects_queued", "Data objects scheduled for movement."},
+        {"objects_moved", "Data objects moved."},
+        {"bytes_moved", "Bytes moved."},
+    }};
+
+    auto counters_to_array(irods::tiering_metrics::transition_counters& _counters)
+        -> std::array<std::atomic<std::uint64_t>*, 5>
+    {
+        return {&_counters.objects_scanned,
+                &_counters.objects_skipped,
+                &_counters.objects_queued,
+                &_counters.objects_moved,
+                &_counters.bytes_moved};
+    } // counters_to_array
+
+    // Adds the deltas recorded by one process to the totals.
+    void merge(nlohmann::json& _totals, const nlohmann::json& _deltas)
+    {
+        auto& transitions = _totals["transitions"];
+        if (!transitions.is_array()) {
+            transitions = nlohmann::json::array();
+        }
+
+        for (const auto& delta : _deltas.at("transitions")) {
+            const auto same_transition = [&delta](const nlohmann::json& _t) {
+                return _t.value("group", "") == delta.at("group") && _t.value("source", "") == delta.at("source") &&
+                       _t.value("destination", "") == delta.at("destination");
+            };
+
+            auto total = std::find_if(std::begin(transitions), std::end(transitions), same_transition);
+            if (std::end(transitions) == total) {
+                transitions.push_back(delta);
+                continue;
+            }
+
+            for (const auto& [name, _] : counter_names) {
+                (*total)[name] = total->value(name, std::uint64_t{0}) + delta.at(name).get<std::uint64_t>();
+            }
+        }
+
+        auto& operations = _totals["operations"];
+        if (!operations.is_object()) {
+            operations = nlohmann::json::object();
+        }
+
+        for (const auto& [name, delta] : _deltas.at("operations").items()) {
+            auto& total = operations[name];
+            if (!total.is_object() || total.value("bucket_counts", nlohmann::json::array()).size() !=
+                                          delta.at("bucket_counts").size()) {
+                total = delta;
+                continue;
+            }
+
+            for (std::size_t i = 0; i < delta.at("bucket_counts").size(); ++i) {
+                total["bucket_counts"][i] =
+                    total["bucket_counts"][i].get<std::uint64_t>() + delta["bucket_counts"][i].get<std::uint64_t>();
+            }
+
+            total["count"] = total.value("count", std::uint64_t{0}) + delta.at("count").get<std::uint64_t>();
+            total["sum_seconds"] = total.value("sum_seconds", 0.0) + delta.at("sum_seconds").get<double>();
+        }
+    } // merge
+
+    auto escape_label_value(const std::string& _value) -> std::string
+    {
+        std::string escaped;
+        escaped.reserve(_value.size());
+        for (const auto c : _value) {
+            switch (c) {
+                case '\\': escaped += "\\\\"; break;
+                case '"':  escaped += "\\\""; break;
+                case '\n': escaped += "\\n"; break;
+                default:   escaped += c; break;
+            }
+        }
+
+        return escaped;
+    } // escape_label_value
+
+    auto to_prometheus_text(const nlohmann::json& _totals) -> std::string
+    {
+        std::string text;
+
+        for (const auto& [name, help] : counter_names) {
+            text += fmt::format("# HELP irods_storage_tiering_{0}_total {1}\n"
+                                "# TYPE irods_storage_tiering_{0}_total counter\n",
+                                name,
+                                help);
+
+            for (const auto& t : _totals.value("transitions", nlohmann::json::array())) {
+                text += fmt::format(
+                    "irods_storage_tiering_{}_total{{group=\"{}\",source=\"{}\",destination=\"{}\"}} {}\n",
+                    name,
+                    escape_label_value(t.value("group", "")),
+                    escape_label_value(t.value("source", "")),
+                    escape_label_value(t.value("destination", "")),
+                    t.value(name, std::uint64_t{0}));
+            }
+        }
+
+        text += "# HELP irods_storage_tiering_operation_duration_seconds Duration of storage tiering operations.\n"
+                "# TYPE irods_storage_tiering_operation_duration_seconds histogram\n";
+
+        const auto& bounds = irods::tiering_metrics::latency_histogram::bucket_bounds_in_seconds;
+        const auto operations = _totals.value("operations", nlohmann::json::object());
+        for (const auto& [name, histogram] : operations.items()) {
+            const auto& counts = histogram.at("bucket_counts");
+
+            // Prometheus buckets are cumulative.
+            std::uint64_t cumulative = 0;
+            for (std::size_t i = 0; i < bounds.size() && i < counts.size(); ++i) {
+                cumulative += counts[i].get<std::uint64_t>();
+                text += fmt::format(
+                    "irods_storage_tiering_operation_duration_seconds_bucket{{operation=\"{}\",le=\"{}\"}} {}\n",
+                    name,
+                    bounds[i],
+                    cumulative);
+            }
+
+            text += fmt::format(
+                "irods_storage_tiering_operation_duration_seconds_bucket{{operation=\"{0}\",le=\"+Inf\"}} {1}\n"
+                "irods_storage_tiering_operation_duration_seconds_sum{{operation=\"{0}\"}} {2}\n"
+                "irods_storage_tiering_operation_duration_seconds_count{{operation=\"{0}\"}} {1}\n",
+                name,
+                histogram.value("count", std::uint64_t{0}),
+                histogram.value("sum_seconds", 0.0));
+        }
+
+        return text;
+    } // to_prometheus_text
+
+    // Writes a file which readers only ever see in full.
+    void replace_file(const fs::path& _path, const std::string& _contents)
+    {
+        const auto temporary_path = fs::path{_path}.concat(fmt::format(".{}", ::getpid()));
+        {
+            std::ofstream file{temporary_path, std::ios::trunc};
+            file << _contents;
+            if (!file.flush()) {
+                THROW(UNIX_FILE_WRITE_ERR, fmt::format("failed to write metrics file [{}]", temporary_path.string()));
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(temporary_path, _path, ec);
+        if (ec) {
+            THROW(UNIX_FILE_RENAME_ERR - ec.value(),
+                  fmt::format("failed to replace metrics file [{}]: {}", _path.string(), ec.message()));
+        }
+    } // replace_file
+} // namespace
+
+namespace irods {
+    void tiering_metrics::latency_histogram::observe(std::chrono::steady_clock::duration _duration) noexcept
+    {
+        const auto seconds = std::chrono::duration<double>{_duration}.count();
+        const auto bucket =
+            std::lower_bound(std::begin(bucket_bounds_in_seconds), std::end(bucket_bounds_in_seconds), seconds);
+
+        counts_[bucket - std::begin(bucket_bounds_in_seconds)].fetch_add(1, std::memory_order_relaxed);
+        sum_in_microseconds_.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(_duration).count(),
+                                       std::memory_order_relaxed);
+    } // observe
+
+    tiering_metrics::scoped_timer::scoped_timer(latency_histogram& _histogram) noexcept
+        : histogram_{_histogram}
+        , start_{std::chrono::steady_clock::now()}
+    {
+    } // ctor
+
+    tiering_metrics::scoped_timer::~scoped_timer()
+    {
+        histogram_.observe(std::chrono::steady_clock::now() - start_);
+    } // dtor
+
+    tiering_metrics::tiering_metrics() = default;
+
+    auto tiering_metrics::instance() -> tiering_metrics&
+    {
+        static tiering_metrics metrics;
+        return metrics;
+    } // instance
+
+    auto tiering_metrics::transition(const std::string& _group_name,
+                                     const std::string& _source_resource,
+                                     const std::string& _destination_resource) -> transition_counters&
+    {
+        const transition_key key{_group_name, _source_resource, _destination_resource};
+
+        {
+            const std::shared_lock lock{transitions_mutex_};
+            if (const auto iter = transitions_.find(key); std::end(transitions_) != iter) {
+                return *iter->second;
+            }
+        }
+
+        const std::unique_lock lock{transitions_mutex_};
+        auto& counters = transitions_[key];
+        if (!counters) {
+            counters = std::make_unique<transition_counters>();
+        }
+
+        return *counters;
+    } // transition
+
+    auto tiering_metrics::histogram(operation _operation) noexcept -> latency_histogram&
+    {
+        return histograms_[static_cast<std::size_t>(_operation)];
+    } // histogram
+
+    auto tiering_metrics::to_json() -> nlohmann::json
+    {
+        return collect(false);
+    } // to_json
+
+    auto tiering_metrics::take() -> nlohmann::json
+    {
+        return collect(true);
+    } // take
+
+    auto tiering_metrics::collect(bool _reset) -> nlohmann::json
+    {
+        // Each value is read on its own, so a value recorded while this runs lands in this delta or the next.
+        const auto read_value = [_reset](std::atomic<std::uint64_t>& _value) {
+            return _reset ? _value.exchange(0, std::memory_order_relaxed) : _value.load(std::memory_order_relaxed);
+        };
+
+        auto metrics =
+            nlohmann::json{{"transitions", nlohmann::json::array()}, {"operations", nlohmann::json::object()}};
+
+        {
+            const std::shared_lock lock{transitions_mutex_};
+            for (const auto& [key, counters] : transitions_) {
+                nlohmann::json t{{"group", std::get<0>(key)},
+                                 {"source", std::get<1>(key)},
+                                 {"destination", std::get<2>(key)}};
+
+                const auto values = counters_to_array(*counters);
+                for (std::size_t i = 0; i < counter_names.size(); ++i) {
+                    t[counter_names[i].first] = read_value(*values[i]);
+                }
+
+                metrics["transitions"].push_back(std::move(t));
+            }
+        }
+
+        for (const auto& [op, name] : operation_names) {
+            auto& h = histograms_[static_cast<std::size_t>(op)];
+
+            auto bucket_counts = nlohmann::json::array();
+            std::uint64_t count = 0;
+            for (auto& c : h.counts_) {
+                const auto n = read_value(c);
+                bucket_counts.push_back(n);
+                count += n;
+            }
+
+            metrics["operations"][name] = {{"bucket_counts", std::move(bucket_counts)},
+                                           {"count", count},
+                                           {"sum_seconds", read_value(h.sum_in_microseconds_) / 1e6}};
+        }
+
+        return metrics;
+    } // collect
+
+    void tiering_metrics::write(const std::filesystem::path& _directory)
+    {
+        last_write_ = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        std::error_code ec;
+        fs::create_directories(_directory, ec);
+        if (ec) {
+            THROW(UNIX_FILE_MKDIR_ERR - ec.value(),
+                  fmt::format("failed to create metrics directory [{}]: {}", _directory.string(), ec.message()));
+        }
+
+        // Every agent on the server adds to the same totals, one at a time.
+        const auto lock_path = _directory / lock_file_name;
+        const auto fd = ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("failed to open metrics lock file [{}]", lock_path.string()));
+        }
+
+        const auto close_lock_file = irods::at_scope_exit{[fd] { ::close(fd); }};
+        if (::flock(fd, LOCK_EX) < 0) {
+            THROW(UNIX_FILE_OPEN_ERR - errno, fmt::format("failed to lock metrics lock file [{}]", lock_path.string()));
+        }
+
+        auto totals = read(_directory);
+        merge(totals, take());
+
+        replace_file(_directory / totals_file_name, totals.dump());
+        replace_file(_directory / prometheus_file_name, to_prometheus_text(totals));
+    } // write
+
+    void tiering_metrics::write_if_due(const std::filesystem::path& _directory, std::chrono::seconds _minimum_interval)
+    {
+        const auto last_write = std::chrono::steady_clock::time_point{std::chrono::steady_clock::duration{last_write_}};
+        if (0 != last_write_ && std::chrono::steady_clock::now() - last_write < _minimum_interval) {
+            return;
+        }
+
+        write(_directory);
+    } // write_if_due
+
+    auto tiering_metrics::read(const std::filesystem::path& _directory) -> nlohmann::json
+    {
+        // Missing or unreadable totals start over from zero.
+        std::ifstream file{_directory / totals_file_name};
+        auto totals = nlohmann::json::parse(file, nullptr, false);
+        if (totals.is_discarded() || !totals.is_object()) {
+            return {{"transitions", nlohmann::json::array()}, {"operations", nlohmann::json::object()}};
+        }
+
+        return totals;
+    } // read
+} // namespace irods
@@ -0,0 +1,124 @@
+#include "irods/private/storage_tiering/movement_trace.hpp"
+
+#include <irods/rodsLog.h>
+
+#include <fmt/format.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <random>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace irods {
+    movement_trace::span::span(const movement_trace& _trace, std::string _name, std::string _object_path)
+        : trace_{_trace}
+        , name_{std::move(_name)}
+        , object_path_{std::move(_object_path)}
+        , start_{clock_type::now()}
+        , uncaught_exceptions_{std::uncaught_exceptions()}
+    {
+    } // ctor
+
+    movement_trace::span::~span()
+    {
+        if (trace_.enabled()) {
+            const bool failed = std::uncaught_exceptions() > uncaught_exceptions_;
+            trace_.record(name_, object_path_, start_, clock_type::now(), failed);
+        }
+    } // dtor
+
+    auto movement_trace::make_movement_id() -> std::string
+    {
+        thread_local std::mt19937_64 generator{std::random_device{}()};
+        std::uniform_int_distribution<std::uint64_t> distribution;
+        return fmt::format("{:016x}{:016x}", distribution(generator), distribution(generator));
+    } // make_movement_id
+
+    auto movement_trace::to_microseconds(clock_type::time_point _time) noexcept -> std::int64_t
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(_time.time_since_epoch()).count();
+    } // to_microseconds
+
+    auto movement_trace::from_microseconds(std::int64_t _microseconds) noexcept -> clock_type::time_point
+    {
+        return clock_type::time_point{
+            std::chrono::duration_cast<clock_type::duration>(std::chrono::microseconds{_microseconds})};
+    } // from_microseconds
+
+    movement_trace::movement_trace(std::filesystem::path _log_path,
+                                   std::string _movement_id,
+                                   nlohmann::json _attributes)
+        : log_path_{std::move(_log_path)}
+        , movement_id_{std::move(_movement_id)}
+        , attributes_{std::move(_attributes)}
+    {
+    } // ctor
+
+    auto movement_trace::enabled() const noexcept -> bool
+    {
+        return !log_path_.empty();
+    } // enabled
+
+    auto movement_trace::movement_id() const noexcept -> const std::string&
+    {
+        return movement_id_;
+    } // movement_id
+
+    void movement_trace::record(const std::string& _name,
+                                const std::string& _object_path,
+                                clock_type::time_point _start,
+                                clock_type::time_point _end,
+                                bool _failed) const noexcept
+    {
+        if (!enabled()) {
+            return;
+        }
+
+        try {
+            auto span = attributes_.is_object() ? attributes_ : nlohmann::json::object();
+            span["movement_id"] = movement_id_;
+            span["span"] = _name;
+            if (!_object_path.empty()) {
+                span["object_path"] = _object_path;
+            }
+            span["start"] = std::chrono::duration<double>{_start.time_since_epoch()}.count();
+            span["duration_seconds"] = std::chrono::duration<double>{_end - _start}.count();
+            span["failed"] = _failed;
+            span["pid"] = ::getpid();
+
+            // Each span is appended with a single write so that the spans of concurrent agents are not interleaved.
+            const auto line = span.dump() + '\n';
+
+            const auto fd = ::open(log_path_.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+            if (fd < 0) {
+                rodsLog(LOG_WARNING, "failed to open movement trace log [%s]: errno [%d]", log_path_.c_str(), errno);
+                return;
+            }
+
+            std::size_t written = 0;
+            while (written < line.size()) {
+                const auto n = ::write(fd, line.data() + written, line.size() - written);
+                if (n < 0) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+
+                    rodsLog(
+                        LOG_WARNING, "failed to write movement trace log [%s]: errno [%d]", log_path_.c_str(), errno);
+                    break;
+                }
+
+                written += static_cast<std::size_t>(n);
+            }
+
+            ::close(fd);
+        }
+        catch (const std::exception& _e) {
+            rodsLog(LOG_WARNING, "failed to record movement trace span [%s]: %s", _name.c_str(), _e.what());
+        }
+    } // record
+} // namespace irods
@@ -0,0 +1,80 @@
+#include "irods/private/storage_tiering/resource_metadata_snapshot.hpp"
+
+#include "irods/private/storage_tiering/catalog_access.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+
+namespace {
+    std::string make_in_list(const std::vector<std::string>& _values)
+    {
+        std::string list;
+        for (const auto& v : _values) {
+            list += fmt::format("'{}',", v);
+        }
+
+        // Pop off the trailing comma to ensure a valid query.
+        if (!list.empty()) {
+            list.pop_back();
+        }
+
+        return list;
+    } // make_in_list
+} // namespace
+
+namespace irods {
+    resource_metadata_snapshot::resource_metadata_snapshot(catalog_access& _catalog,
+                                                           RcComm* _comm,
+                                                           const std::vector<std::string>& _resource_names,
+                                                           const std::vector<std::string>& _attribute_names)
+        : resource_names_{_resource_names}
+        , attribute_names_{_attribute_names}
+    {
+        if (resource_names_.empty() || attribute_names_.empty()) {
+            return;
+        }
+
+        const auto query_str = fmt::format("select RESC_NAME, META_RESC_ATTR_NAME, META_RESC_ATTR_VALUE, "
+                                           "META_RESC_ATTR_UNITS where RESC_NAME in ({}) and META_RESC_ATTR_NAME in ({})",
+                                           make_in_list(resource_names_),
+                                           make_in_list(attribute_names_));
+
+        for (const auto& row : _catalog.query_rows(_comm, query_str)) {
+            metadata_[row[0]][row[1]].emplace_back(row[2], row[3]);
+        }
+    } // ctor
+
+    auto resource_metadata_snapshot::find(const std::string& _resource_name, const std::string& _attribute_name) const
+        -> const metadata_results*
+    {
+        static const metadata_results no_results;
+
+        const auto covers = [](const std::vector<std::string>& _names, const std::string& _name) {
+            return std::find(std::begin(_names), std::end(_names), _name) != std::end(_names);
+        };
+
+        if (!covers(resource_names_, _resource_name) || !covers(attribute_names_, _attribute_name)) {
+            return nullptr;
+        }
+
+        ++catalog_queries_avoided_;
+
+        const auto resc_iter = metadata_.find(_resource_name);
+        if (std::end(metadata_) == resc_iter) {
+            return &no_results;
+        }
+
+        const auto attr_iter = resc_iter->second.find(_attribute_name);
+        if (std::end(resc_iter->second) == attr_iter) {
+            return &no_results;
+        }
+
+        return &attr_iter->second;
+    } // find
+
+    auto resource_metadata_snapshot::catalog_queries_avoided() const noexcept -> std::uint64_t
+    {
+        return catalog_queries_avoided_.load();
+    } // catalog_queries_avoided
+} // namespace irods
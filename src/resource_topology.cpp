@@ -0,0 +1,77 @@
+#include "irods/private/storage_tiering/resource_topology.hpp"
+
+#include <irods/irods_exception.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+
+extern irods::resource_manager resc_mgr;
+
+namespace {
+    auto make_resource_entry(const std::string& _resource_name) -> irods::resource_topology::resource_entry
+    {
+        irods::resource_topology::resource_entry entry;
+
+        for (const auto& bundle : resc_mgr.gather_leaf_bundles_for_resc(_resource_name)) {
+            entry.leaf_ids.insert(std::end(entry.leaf_ids), std::begin(bundle), std::end(bundle));
+        }
+
+        // if there is no hierarchy
+        if (entry.leaf_ids.empty()) {
+            rodsLong_t resc_id{};
+            if (const auto err = resc_mgr.hier_to_leaf_id(_resource_name, resc_id); !err.ok()) {
+                THROW(err.code(), err.result());
+            }
+            entry.leaf_ids.push_back(resc_id);
+        }
+
+        std::sort(std::begin(entry.leaf_ids), std::end(entry.leaf_ids));
+
+        for (const auto id : entry.leaf_ids) {
+            entry.leaf_id_list += fmt::format("'{}',", id);
+        }
+
+        // Pop off the trailing comma to ensure a valid query.
+        entry.leaf_id_list.pop_back();
+
+        return entry;
+    } // make_resource_entry
+} // namespace
+
+namespace irods {
+    auto resource_topology::instance() -> resource_topology&
+    {
+        static resource_topology topology;
+        return topology;
+    } // instance
+
+    auto resource_topology::find(const std::string& _resource_name) -> std::shared_ptr<const resource_entry>
+    {
+        // Resolving the name is a lookup in the resource manager's map. It tells us whether the resource manager
+        // still holds the same resource as when the entry was built.
+        resource_ptr resource;
+        if (const auto err = resc_mgr.resolve(_resource_name, resource); !err.ok()) {
+            THROW(err.code(), err.result());
+        }
+
+        const std::lock_guard lock{mutex_};
+
+        if (const auto iter = resources_.find(_resource_name);
+            std::end(resources_) != iter && iter->second.resource == resource)
+        {
+            return iter->second.entry;
+        }
+
+        auto entry = std::make_shared<const resource_entry>(make_resource_entry(_resource_name));
+
+        resources_[_resource_name] = {std::move(resource), entry};
+
+        return entry;
+    } // find
+
+    auto resource_topology::leaf_id_list(const std::string& _resource_name) -> std::string
+    {
+        return find(_resource_name)->leaf_id_list;
+    } // leaf_id_list
+} // namespace irods
@@ -3,11 +3,18 @@
 
 #include "irods/private/storage_tiering/storage_tiering.hpp"
 
+#include "irods/private/storage_tiering/access_time_index.hpp"
+#include "irods/private/storage_tiering/batch_collector.hpp"
+#include "irods/private/storage_tiering/data_id_set.hpp"
+#include "irods/private/storage_tiering/executor.hpp"
+#include "irods/private/storage_tiering/metrics.hpp"
+#include "irods/private/storage_tiering/movement_trace.hpp"
 #include "irods/private/storage_tiering/utilities.hpp"
 
 #include <irods/client_connection.hpp>
 #include <irods/escape_utilities.hpp>
 #include <irods/execMyRule.h>
+#include <irods/irods_at_scope_exit.hpp>
 #include <irods/irods_hierarchy_parser.hpp>
 #include <irods/irods_logger.hpp>
 #include <irods/irods_query.hpp>
@@ -19,7 +26,6 @@
 #include <irods/irods_version.h>
 #include <irods/modAVUMetadata.h>
 #include <irods/objInfo.h>
-#include <irods/query_processor.hpp>
 #include <irods/rsCloseCollection.hpp>
 #include <irods/rsExecMyRule.hpp>
 #include <irods/rsOpenCollection.hpp>
@@ -35,9 +41,20 @@
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
 #include <charconv>
-#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <optional>
 #include <random>
+#include <set>
 #include <system_error>
 #include <tuple>
 
@@ -49,7 +66,98 @@ int _delayExec(
     const char *delayCondition,
     ruleExecInfo_t *rei );
 
+namespace {
+    // The orders in which violating objects may be evicted from a resource.
+    namespace eviction_order {
+        const std::string access_time{"access_time"};
+        const std::string size{"size"};
+        const std::string score{"score"};
+    } // namespace eviction_order
+
+    // Sorts rows of an ordered violating query by the product of the time since the object was last accessed and
+    // its size, highest first. This favors objects which have held the most bytes idle for the longest.
+    void sort_by_eviction_score(std::vector<std::vector<std::string>>& _rows)
+    {
+        const auto now = static_cast<long double>(std::time(nullptr));
+        const auto score = [now](const std::vector<std::string>& _row) -> long double {
+            try {
+                const auto size        = boost::lexical_cast<long double>(_row.at(6));
+                const auto access_time = boost::lexical_cast<long double>(_row.at(7));
+                return std::max(now - access_time, 0.0L) * size;
+            }
+            catch(const std::exception&) {
+                return 0;
+            }
+        };
+
+        std::vector<std::pair<long double, std::size_t>> scores;
+        scores.reserve(_rows.size());
+        for(std::size_t i = 0; i < _rows.size(); ++i) {
+            scores.emplace_back(score(_rows[i]), i);
+        }
+
+        std::stable_sort(std::begin(scores), std::end(scores), [](const auto& _lhs, const auto& _rhs) {
+            return _lhs.first > _rhs.first;
+        });
+
+        std::vector<std::vector<std::string>> sorted;
+        sorted.reserve(_rows.size());
+        for(const auto& [_, i] : scores) {
+            sorted.push_back(std::move(_rows[i]));
+        }
+
+        _rows.swap(sorted);
+    } // sort_by_eviction_score
+
+    // Aggregates over no rows are empty.
+    auto aggregate_to_count(const std::string& _value) -> std::uint64_t
+    {
+        return _value.empty() ? 0 : boost::lexical_cast<std::uint64_t>(_value);
+    } // aggregate_to_count
+
+    // The number of violating replicas and their bytes in each of a fixed set of size ranges, as reported by a dry
+    // run. Each range runs from the upper bound of the previous one, and the last has no upper bound.
+    struct size_distribution {
+        static constexpr std::array<std::uint64_t, 5> upper_bounds{
+            std::uint64_t{64} << 10, std::uint64_t{1} << 20, std::uint64_t{16} << 20, std::uint64_t{256} << 20,
+            std::uint64_t{4} << 30};
 
+        static constexpr auto lower_bound(std::size_t _range) -> std::uint64_t
+        {
+            return 0 == _range ? 0 : upper_bounds[_range - 1];
+        }
+
+        std::array<std::uint64_t, upper_bounds.size() + 1> objects{};
+        std::array<std::uint64_t, upper_bounds.size() + 1> bytes{};
+
+        void add(std::uint64_t _data_size)
+        {
+            const auto range = static_cast<std::size_t>(
+                std::upper_bound(std::begin(upper_bounds), std::end(upper_bounds), _data_size) -
+                std::begin(upper_bounds));
+            ++objects[range];
+            bytes[range] += _data_size;
+        }
+
+        auto to_json() const -> nlohmann::json
+        {
+            auto ranges = nlohmann::json::array();
+            for(std::size_t i = 0; i < objects.size(); ++i) {
+                nlohmann::json maximum_data_size;
+                if(i < upper_bounds.size()) {
+                    maximum_data_size = upper_bounds[i] - 1;
+                }
+
+                ranges.push_back({{"minimum_data_size", lower_bound(i)},
+                                  {"maximum_data_size", maximum_data_size},
+                                  {"objects", objects[i]},
+                                  {"bytes", bytes[i]}});
+            }
+
+            return ranges;
+        }
+    }; // struct size_distribution
+} // namespace
 
 namespace irods {
     using log_re = irods::experimental::log::rule_engine;
@@ -57,6 +165,7 @@ namespace irods {
     const std::string storage_tiering::policy::storage_tiering{"irods_policy_storage_tiering"};
     const std::string storage_tiering::policy::data_movement{"irods_policy_data_movement"};
     const std::string storage_tiering::policy::access_time{"irods_policy_apply_access_time"};
+    const std::string storage_tiering::policy::metrics{"irods_policy_storage_tiering_metrics"};
 
     const std::string storage_tiering::schedule::storage_tiering{"irods_policy_schedule_storage_tiering"};
     const std::string storage_tiering::schedule::data_movement{"irods_policy_schedule_data_object_movement"};
@@ -64,10 +173,23 @@ namespace irods {
     storage_tiering::storage_tiering(
         rcComm_t*          _comm,
         ruleExecInfo_t*    _rei,
-        const std::string& _instance_name) :
-          comm_(_comm)
-        , rei_(_rei)
-        , config_(_instance_name) {
+        std::shared_ptr<const storage_tiering_configuration> _config,
+        std::shared_ptr<storage_tiering_connection_pool> _connection_pool,
+        std::shared_ptr<storage_tiering_executors> _executors,
+        std::shared_ptr<catalog_access> _catalog) :
+          rei_(_rei)
+        , comm_(_comm)
+        , config_snapshot_(std::move(_config))
+        , config_(*config_snapshot_)
+        , connection_pool_(std::move(_connection_pool))
+        , executors_(std::move(_executors))
+        , catalog_(_catalog ? std::move(_catalog)
+                            : make_catalog_access(
+                                  std::chrono::microseconds{config_.catalog_lookup_coalescing_window_in_microseconds}))
+        , catalog_query_slots_(std::make_unique<std::counting_semaphore<>>(
+              config_.maximum_concurrent_catalog_queries > 0
+                  ? config_.maximum_concurrent_catalog_queries
+                  : std::max(config_.number_of_concurrent_tier_transitions, 1))) {
 
     }
 
@@ -77,18 +199,8 @@ namespace irods {
         rcComm_t*          _comm,
         const std::string& _meta_attr_name,
         const std::string& _object_path ) {
-        boost::filesystem::path p{irods::single_quotes_to_hex(_object_path)};
-        std::string coll_name = p.parent_path().string();
-        std::string data_name = p.filename().string();
-
-        const auto query_str = fmt::format(
-            "select META_DATA_ATTR_VALUE where META_DATA_ATTR_NAME = '{}' and DATA_NAME = '{}' and COLL_NAME = '{}'",
-            _meta_attr_name,
-            data_name,
-            coll_name);
-        query<rcComm_t> qobj{_comm, query_str, 1};
-        if(qobj.size() > 0) {
-            return qobj.front()[0];
+        if(const auto avus = catalog_->data_object_metadata(_comm, _object_path, _meta_attr_name); !avus.empty()) {
+            return avus.front().first;
         }
 
         THROW(
@@ -102,13 +214,27 @@ namespace irods {
         rcComm_t*          _comm,
         const std::string& _meta_attr_name,
         const std::string& _resource_name ) {
+        if (resource_metadata_) {
+            if (const auto* results = resource_metadata_->find(_resource_name, _meta_attr_name); results) {
+                if (!results->empty()) {
+                    return results->front().first;
+                }
+
+                THROW(
+                    CAT_NO_ROWS_FOUND,
+                    boost::format("no results found for resc [%s] with attribute [%s]") %
+                    _resource_name %
+                    _meta_attr_name);
+            }
+        }
+
         const auto query_str =
             fmt::format("select META_RESC_ATTR_VALUE where META_RESC_ATTR_NAME = '{}' and RESC_NAME = '{}'",
                         _meta_attr_name,
                         _resource_name);
-        query<rcComm_t> qobj{_comm, query_str, 1};
-        if(qobj.size() > 0) {
-            return qobj.front()[0];
+        const auto rows = catalog_->query_rows(_comm, query_str, 1);
+        if(!rows.empty()) {
+            return rows.front()[0];
         }
 
         THROW(
@@ -123,13 +249,28 @@ namespace irods {
         const std::string&  _meta_attr_name,
         const std::string&  _resource_name,
         metadata_results&   _results ) {
+        if (resource_metadata_) {
+            if (const auto* results = resource_metadata_->find(_resource_name, _meta_attr_name); results) {
+                if (!results->empty()) {
+                    _results.insert(_results.end(), results->begin(), results->end());
+                    return;
+                }
+
+                THROW(
+                    CAT_NO_ROWS_FOUND,
+                    boost::format("no results found for resc [%s] with attribute [%s]") %
+                    _resource_name %
+                    _meta_attr_name);
+            }
+        }
+
         const auto query_str = fmt::format(
             "select META_RESC_ATTR_VALUE, META_RESC_ATTR_UNITS where META_RESC_ATTR_NAME = '{}' and RESC_NAME = '{}'",
             _meta_attr_name,
             _resource_name);
-        query<rcComm_t> qobj{_comm, query_str};
-        if(qobj.size() > 0) {
-            for( const auto& r : qobj) {
+        const auto rows = catalog_->query_rows(_comm, query_str);
+        if(!rows.empty()) {
+            for( const auto& r : rows) {
                 _results.push_back(std::make_pair(r[0], r[1]));
             }
 
@@ -151,7 +292,7 @@ namespace irods {
             "select RESC_ID, META_RESC_ATTR_UNITS where META_RESC_ATTR_NAME = '{}' and META_RESC_ATTR_VALUE = '{}'",
             config_.group_attribute,
             _group_name);
-        for(auto row : query<rcComm_t>{_comm, query_str}) {
+        for(auto row : catalog_->query_rows(_comm, query_str)) {
             std::string& resc_name = row[0];
             std::string& tier_idx  = row[1];
 
@@ -180,40 +321,6 @@ namespace irods {
         return resc_map;
     } // get_tier_group_resource_ids_and_indices
 
-    std::string storage_tiering::get_leaf_resources_string(
-            const std::string& _resource_name) {
-        std::string leaf_id_str;
-
-        // if the resource has no children then simply return
-        resource_ptr root_resc;
-        error err = resc_mgr.resolve(_resource_name, root_resc);
-        if(!err.ok()) {
-            THROW(err.code(), err.result());
-        }
-
-        std::vector<resource_manager::leaf_bundle_t> leaf_bundles = 
-            resc_mgr.gather_leaf_bundles_for_resc(_resource_name);
-        for(const auto & bundle : leaf_bundles) {
-            for(const auto & leaf_id : bundle) {
-                leaf_id_str += 
-                    "'" + boost::str(boost::format("%s") % leaf_id) + "',";
-            } // for
-        } // for
-
-        // if there is no hierarchy
-        if(leaf_id_str.empty()) {
-            rodsLong_t resc_id;
-            resc_mgr.hier_to_leaf_id(_resource_name, resc_id);
-            return fmt::format("'{}'", resc_id);
-        }
-
-        // Pop off the trailing comma to ensure a valid query.
-        leaf_id_str.pop_back();
-
-        return leaf_id_str;
-
-    } // get_leaf_resources_string
-
     bool storage_tiering::get_preserve_replicas_for_resc(
           rcComm_t*          _comm
         , const std::string& _resource_name) {
@@ -246,6 +353,20 @@ namespace irods {
 
     } // get_verification_for_resc
 
+    std::string storage_tiering::get_data_movement_mode_for_resc(
+          rcComm_t*          _comm
+        , const std::string& _resource_name) {
+        try {
+            return get_metadata_for_resource(
+                       _comm,
+                       config_.data_movement_mode,
+                       _resource_name);
+        }
+        catch(const exception&) {
+            return "replicate";
+        }
+    } // get_data_movement_mode_for_resc
+
     std::string storage_tiering::get_restage_tier_resource_name(
         rcComm_t*          _comm,
         const std::string& _group_name) {
@@ -266,10 +387,10 @@ namespace irods {
             "select RESC_NAME where META_RESC_ATTR_NAME = '{}' and META_RESC_ATTR_VALUE = 'true' and RESC_ID IN ({})",
             config_.minimum_restage_tier,
             resc_list);
-        query<rcComm_t> qobj{_comm, query_str, 1};
-        if(qobj.size() > 0) {
-            const auto& result = qobj.front();
-            if(qobj.size() > 1) {
+        const auto rows = catalog_->query_rows(_comm, query_str, 1);
+        if(!rows.empty()) {
+            const auto& result = rows.front();
+            if(rows.size() > 1) {
                 rodsLog(
                     LOG_ERROR,
                     "multiple [%s] tags defined.  selecting resource [%s]",
@@ -305,7 +426,7 @@ namespace irods {
                                               _group_name,
                                               _resource_name);
 
-        const auto query = irods::query{_comm, query_string};
+        const auto query = catalog_->query_rows(_comm, query_string);
 
         if (query.empty()) {
             THROW(CAT_NO_ROWS_FOUND,
@@ -424,8 +545,7 @@ namespace irods {
                                                "'{}' and META_RESC_ATTR_NAME = '{}'",
                                                _group,
                                                config_.group_attribute);
-            query<rcComm_t> qobj{_comm, query_str};
-            for(const auto& g : qobj) {
+            for(const auto& g : catalog_->query_rows(_comm, query_str)) {
                 groups[g[0]] = g[1];
             }
 
@@ -464,9 +584,12 @@ namespace irods {
 
     } // get_tier_time_for_resc
 
-    storage_tiering::metadata_results storage_tiering::get_violating_queries_for_resource(
+    std::vector<storage_tiering::violating_query> storage_tiering::get_violating_queries_for_resource(
         rcComm_t*          _comm,
-        const std::string& _resource_name) {
+        const std::string& _resource_name,
+        uint32_t           _object_limit,
+        const std::string& _eviction_order,
+        const bool         _use_access_time_index) {
 
         const auto tier_time = get_tier_time_for_resc(_comm, _resource_name);
         try {
@@ -496,25 +619,89 @@ namespace irods {
                     query_type_str.c_str());
             } // for
 
-            return results;
+            std::vector<violating_query> queries;
+            for(auto& q_itr : results) {
+                queries.push_back({std::move(q_itr.first), std::move(q_itr.second), false, false, {}, std::nullopt});
+            }
+
+            return queries;
         }
         catch(const exception&) {
-            const auto leaf_str = get_leaf_resources_string(_resource_name);
-            metadata_results results;
-            results.push_back(std::make_pair(
-                fmt::format(
-                    "select DATA_NAME, COLL_NAME, USER_NAME, USER_ZONE, DATA_REPL_NUM where META_DATA_ATTR_NAME = '{}' "
-                    "and META_DATA_ATTR_VALUE < '{}' and META_DATA_ATTR_UNITS <> '{}' and DATA_RESC_ID in ({})",
+            const auto leaf_str = catalog_->leaf_id_list(_resource_name);
+            auto query_string = fmt::format(
+                "select DATA_NAME, COLL_NAME, USER_NAME, USER_ZONE, DATA_REPL_NUM, DATA_ID where "
+                "META_DATA_ATTR_NAME = '{}' and META_DATA_ATTR_VALUE < '{}' and META_DATA_ATTR_UNITS <> '{}' "
+                "and DATA_RESC_ID in ({})",
+                config_.access_time_attribute,
+                tier_time,
+                config_.migration_scheduled_flag,
+                leaf_str);
+
+            // An eviction order takes precedence over the cursor, as each pass must start again from the objects
+            // which are most worth moving. Access times are stored as fixed width epoch seconds, so ordering the
+            // attribute value as a string orders by time. A score cannot be computed by the catalog, so the rows
+            // of that query are sorted after they have been read.
+            if(!_eviction_order.empty()) {
+                const auto size_column        = eviction_order::size == _eviction_order ? "ORDER_DESC(DATA_SIZE)"
+                                                                                        : "DATA_SIZE";
+                const auto access_time_column = eviction_order::access_time == _eviction_order
+                                                    ? "ORDER(META_DATA_ATTR_VALUE)"
+                                                    : "META_DATA_ATTR_VALUE";
+                query_string = fmt::format(
+                    "select DATA_NAME, COLL_NAME, USER_NAME, USER_ZONE, DATA_REPL_NUM, DATA_ID, {}, {} where "
+                    "META_DATA_ATTR_NAME = '{}' and META_DATA_ATTR_VALUE < '{}' and META_DATA_ATTR_UNITS <> '{}' "
+                    "and DATA_RESC_ID in ({})",
+                    size_column,
+                    access_time_column,
                     config_.access_time_attribute,
                     tier_time,
                     config_.migration_scheduled_flag,
-                    leaf_str),
-                ""));
-            rodsLog(
-                config_.data_transfer_log_level_value,
-                "use default query for [%s]",
-                _resource_name.c_str());
-            return results;
+                    leaf_str);
+
+                rodsLog(
+                    config_.data_transfer_log_level_value,
+                    "use default query ordered by [%s] for [%s]",
+                    _eviction_order.c_str(),
+                    _resource_name.c_str());
+                return {{std::move(query_string), "", true, false, _eviction_order, std::nullopt}};
+            }
+
+            // When each pass is limited to a number of objects, walk the violating objects in DATA_ID order and
+            // pick up where the previous pass stopped so that the same objects are not read over and over.
+            const bool resumable = _object_limit > 0;
+            if(resumable) {
+                query_string = fmt::format(
+                    "select DATA_NAME, COLL_NAME, USER_NAME, USER_ZONE, DATA_REPL_NUM, ORDER(DATA_ID) where "
+                    "META_DATA_ATTR_NAME = '{}' and META_DATA_ATTR_VALUE < '{}' and META_DATA_ATTR_UNITS <> '{}' "
+                    "and DATA_RESC_ID in ({}) and DATA_ID > '{}'",
+                    config_.access_time_attribute,
+                    tier_time,
+                    config_.migration_scheduled_flag,
+                    leaf_str,
+                    get_violating_query_cursor_for_resource(_comm, _resource_name));
+            }
+
+            // The index is only consulted when a pass considers every violating object.
+            std::optional<access_time_index_pass> index_pass;
+            if(_use_access_time_index && !resumable) {
+                index_pass = make_access_time_index_pass(_resource_name, boost::lexical_cast<std::time_t>(tier_time));
+            }
+
+            if(index_pass && !index_pass->full_scan) {
+                rodsLog(
+                    config_.data_transfer_log_level_value,
+                    "use default query for [%lu] candidates from the access time index for [%s]",
+                    index_pass->candidates.size(),
+                    _resource_name.c_str());
+            }
+            else {
+                rodsLog(
+                    config_.data_transfer_log_level_value,
+                    "use default query for [%s]",
+                    _resource_name.c_str());
+            }
+
+            return {{std::move(query_string), "", true, resumable, {}, std::move(index_pass)}};
         }
     } // get_violating_queries_for_resource
 
@@ -546,31 +733,268 @@ namespace irods {
         }
     } // get_object_limit_for_resource
 
-    bool storage_tiering::skip_object_in_lower_tier(
+    auto storage_tiering::make_access_time_index_pass(
+        const std::string& _resource_name,
+        std::time_t        _threshold) -> std::optional<access_time_index_pass> {
+        if(config_.access_time_index_directory.empty()) {
+            return std::nullopt;
+        }
+
+        // The catalog is scanned in full periodically, and whenever the index cannot be used, to find the
+        // violating objects whose access times were written elsewhere.
+        try {
+            const access_time_index index{
+                config_.access_time_index_directory,
+                std::chrono::seconds{config_.access_time_index_bucket_size_in_seconds}};
+
+            const auto state = index.load_state(_resource_name);
+            if(state &&
+               std::time(nullptr) - state->last_full_scan < config_.access_time_index_full_scan_interval_in_seconds) {
+                return access_time_index_pass{_threshold, false, index.read(state->consumed_until, _threshold)};
+            }
+        }
+        catch(const irods::exception& _e) {
+            irods::log(_e);
+        }
+
+        return access_time_index_pass{_threshold, true, {}};
+    } // make_access_time_index_pass
+
+    void storage_tiering::complete_access_time_index_pass(
+        const std::string&            _resource_name,
+        const access_time_index_pass& _pass) {
+        try {
+            const access_time_index index{
+                config_.access_time_index_directory,
+                std::chrono::seconds{config_.access_time_index_bucket_size_in_seconds}};
+
+            const auto now = std::time(nullptr);
+            auto state = index.load_state(_resource_name);
+            if(_pass.full_scan || !state) {
+                state = access_time_index::resource_state{_pass.threshold, now};
+            }
+            else {
+                // The threshold moves back if the tier time of the resource is raised. Access times which have
+                // already been considered are not read again.
+                state->consumed_until = std::max(state->consumed_until, _pass.threshold);
+            }
+
+            index.save_state(_resource_name, *state);
+            index.prune(now - 2 * static_cast<std::time_t>(config_.access_time_index_full_scan_interval_in_seconds));
+        }
+        catch(const irods::exception& _e) {
+            irods::log(_e);
+        }
+    } // complete_access_time_index_pass
+
+    auto storage_tiering::get_eviction_budget_for_resource(
         rcComm_t*          _comm,
-        const std::string& _object_path,
-        const std::string& _partial_list) {
-        boost::filesystem::path p{irods::single_quotes_to_hex(_object_path)};
-        std::string coll_name = p.parent_path().string();
-        std::string data_name = p.filename().string();
-        const auto qstr =
-            fmt::format("select RESC_ID WHERE DATA_NAME = '{}' and COLL_NAME = '{}' and DATA_RESC_ID in ({})",
-                        data_name,
-                        coll_name,
-                        _partial_list);
-
-        query<rcComm_t> qobj{_comm, qstr};
-        bool skip = qobj.size() > 0;
-        if(skip) {
+        const std::string& _resource_name) -> std::optional<eviction_budget> {
+        try {
+            metadata_results results;
+            get_metadata_for_resource(
+                _comm,
+                config_.eviction_budget,
+                _resource_name,
+                results);
+
+            const auto& [value, units] = results.front();
+            if(units.empty() || "bytes" == units) {
+                return eviction_budget{boost::lexical_cast<std::uint64_t>(value), true};
+            }
+
+            if("objects" == units) {
+                return eviction_budget{boost::lexical_cast<std::uint64_t>(value), false};
+            }
+
+            THROW(
+                SYS_INVALID_INPUT_PARAM,
+                boost::format("invalid units [%s] for attribute [%s] on resource [%s] : expected bytes or objects") %
+                units %
+                config_.eviction_budget %
+                _resource_name);
+        }
+        catch(const boost::bad_lexical_cast& _e) {
+            THROW(
+                INVALID_LEXICAL_CAST,
+                _e.what());
+        }
+        catch(const irods::exception& _e) {
+            if(CAT_NO_ROWS_FOUND == _e.code()) {
+                return std::nullopt;
+            }
+
+            throw;
+        }
+    } // get_eviction_budget_for_resource
+
+    std::string storage_tiering::get_eviction_order_for_resource(
+        rcComm_t*          _comm,
+        const std::string& _resource_name,
+        bool               _has_eviction_budget) {
+        std::string order;
+        try {
+            order = get_metadata_for_resource(
+                        _comm,
+                        config_.eviction_order,
+                        _resource_name);
+        }
+        catch(const irods::exception& _e) {
+            if(CAT_NO_ROWS_FOUND != _e.code()) {
+                throw;
+            }
+        }
+
+        if(order.empty()) {
+            return _has_eviction_budget ? eviction_order::access_time : std::string{};
+        }
+
+        if(eviction_order::access_time != order && eviction_order::size != order && eviction_order::score != order) {
+            THROW(
+                SYS_INVALID_INPUT_PARAM,
+                boost::format("invalid value [%s] for attribute [%s] on resource [%s] : expected %s, %s or %s") %
+                order %
+                config_.eviction_order %
+                _resource_name %
+                eviction_order::access_time %
+                eviction_order::size %
+                eviction_order::score);
+        }
+
+        return order;
+    } // get_eviction_order_for_resource
+
+    uint64_t storage_tiering::get_violating_query_cursor_for_resource(
+        rcComm_t*          _comm,
+        const std::string& _resource_name) {
+        try {
+            return boost::lexical_cast<uint64_t>(
+                get_metadata_for_resource(_comm, config_.violating_query_cursor, _resource_name));
+        }
+        catch(const boost::bad_lexical_cast&) {
+            rodsLog(
+                LOG_WARNING,
+                "invalid violating query cursor for resource [%s], starting from the beginning",
+                _resource_name.c_str());
+            return 0;
+        }
+        catch(const irods::exception& _e) {
+            if(CAT_NO_ROWS_FOUND == _e.code()) {
+                return 0;
+            }
+
+            throw;
+        }
+    } // get_violating_query_cursor_for_resource
+
+    void storage_tiering::set_violating_query_cursor_for_resource(
+        rcComm_t*          _comm,
+        const std::string& _resource_name,
+        uint64_t           _cursor) {
+        if (const auto ec = catalog_->set_resource_metadata(
+                _comm, _resource_name, config_.violating_query_cursor, std::to_string(_cursor));
+            ec < 0) {
+            THROW(
+                ec,
+                boost::format("failed to set violating query cursor for resource [%s]") %
+                _resource_name);
+        }
+    } // set_violating_query_cursor_for_resource
+
+    void storage_tiering::set_data_sizes_for_objects(
+        rcComm_t*                      _comm,
+        std::vector<violating_object>& _objects,
+        const std::string&             _source_resource) {
+        std::vector<std::string> object_paths;
+        object_paths.reserve(_objects.size());
+        for(const auto& o : _objects) {
+            object_paths.push_back(o.object_path);
+        }
+
+        const auto leaf_id_list = catalog_->leaf_id_list(_source_resource);
+
+        std::map<std::string, rodsLong_t> data_sizes;
+        for(const auto& chunk : make_logical_path_query_chunks(object_paths)) {
+            const auto qstr = fmt::format("select COLL_NAME, DATA_NAME, DATA_SIZE where COLL_NAME in ({}) and "
+                                          "DATA_NAME in ({}) and DATA_RESC_ID in ({}) and DATA_REPL_STATUS = '1'",
+                                          chunk.collection_names,
+                                          chunk.data_names,
+                                          leaf_id_list);
+
+            for(const auto& row : catalog_->query_rows(_comm, qstr)) {
+                data_sizes.emplace(make_logical_path(row[0], row[1]), boost::lexical_cast<rodsLong_t>(row[2]));
+            }
+        }
+
+        for(auto& o : _objects) {
+            if(const auto itr = data_sizes.find(o.object_path); itr != data_sizes.end()) {
+                o.data_size = itr->second;
+            }
+        }
+    } // set_data_sizes_for_objects
+
+    void storage_tiering::skip_objects_in_lower_tiers(
+        rcComm_t*                      _comm,
+        std::vector<violating_object>& _objects,
+        const std::string&             _partial_list) {
+        std::vector<std::string> object_paths;
+        object_paths.reserve(_objects.size());
+        for(const auto& o : _objects) {
+            object_paths.push_back(o.object_path);
+        }
+
+        // The IN conditions match every pairing of the collection and data names in a chunk, so only the logical
+        // paths which were actually asked about are considered.
+        std::set<std::string> in_lower_tier;
+        for(const auto& chunk : make_logical_path_query_chunks(object_paths)) {
+            const auto qstr = fmt::format("select COLL_NAME, DATA_NAME where COLL_NAME in ({}) and DATA_NAME in ({}) "
+                                          "and DATA_RESC_ID in ({})",
+                                          chunk.collection_names,
+                                          chunk.data_names,
+                                          _partial_list);
+
+            for(const auto& row : catalog_->query_rows(_comm, qstr)) {
+                in_lower_tier.insert(make_logical_path(row[0], row[1]));
+            }
+        }
+
+        const auto skip = [&](const violating_object& _object) {
+            if(0 == in_lower_tier.count(_object.object_path)) {
+                return false;
+            }
+
             rodsLog(
                 config_.data_transfer_log_level_value,
                 "irods::storage_tiering - skipping migration for [%s] in resource list [%s]",
-                _object_path.c_str(),
+                _object.object_path.c_str(),
                 _partial_list.c_str());
-        }
 
-        return skip;
-    } // skip_object_in_lower_tier
+            return true;
+        };
+
+        _objects.erase(std::remove_if(std::begin(_objects), std::end(_objects), skip), std::end(_objects));
+    } // skip_objects_in_lower_tiers
+
+    auto storage_tiering::make_resource_metadata_snapshot(
+        rcComm_t*                       _comm,
+        const std::vector<std::string>& _resource_names) -> std::shared_ptr<const resource_metadata_snapshot> {
+        // Every per-resource attribute consulted while scheduling data movements for the tier groups in a pass.
+        const std::vector<std::string> attribute_names{
+            config_.time_attribute,
+            config_.query_attribute,
+            config_.verification_attribute,
+            config_.data_movement_parameters_attribute,
+            config_.preserve_replicas,
+            config_.object_limit,
+            config_.violating_query_cursor,
+            config_.eviction_budget,
+            config_.eviction_order,
+            config_.data_movement_mode,
+            config_.minimum_delay_time,
+            config_.maximum_delay_time};
+
+        return std::make_shared<const resource_metadata_snapshot>(*catalog_, _comm, _resource_names, attribute_names);
+    } // make_resource_metadata_snapshot
 
     void storage_tiering::migrate_violating_data_objects(
         rcComm_t*          _comm,
@@ -578,42 +1002,155 @@ namespace irods {
         const std::string& _partial_list,
         const std::string& _source_resource,
         const std::string& _destination_resource) {
-        using result_row = irods::query_processor<rcComm_t>::result_row;
+        using result_row = std::vector<std::string>;
 
         constexpr auto number_of_columns_required_from_query = 5;
+        constexpr auto number_of_columns_from_default_query = 6;
+        constexpr auto number_of_columns_from_ordered_query = 8;
 
-        irods::thread_pool thread_pool{config_.number_of_scheduling_threads};
         try {
-            // TODO(#298): Consider changing this from std::map to std::unordered_set since the value is never used.
-            std::map<std::string, uint8_t> object_is_processed;
-            std::mutex object_is_processed_mutex;
+            // Objects are keyed by DATA_ID when the query provides it and by a hash of the logical path otherwise.
+            // The default query is only used when no custom queries are configured, so the two never mix.
+            data_id_set object_is_processed;
             const bool preserve_replicas = get_preserve_replicas_for_resc(_comm, _source_resource);
             const auto query_limit       = get_object_limit_for_resource(_comm, _source_resource);
-            const auto query_list        = get_violating_queries_for_resource(_comm, _source_resource);
+            const auto budget            = get_eviction_budget_for_resource(_comm, _source_resource);
+            const auto order             = get_eviction_order_for_resource(_comm, _source_resource, budget.has_value());
+            const auto query_list =
+                get_violating_queries_for_resource(_comm, _source_resource, query_limit, order, true);
+
+            // The budget is spent on the rows of ordered queries in the order they are admitted, before any of the
+            // rows are handed to the scheduling threads. Rows for replicas of an object already admitted are free.
+            std::uint64_t budget_spent = 0;
+            std::set<std::string> budgeted_objects;
+            const auto within_budget = [&](const violating_query& _query, const result_row& _row) {
+                if(!budget || _query.eviction_order.empty()) {
+                    return true;
+                }
+
+                if(budgeted_objects.count(_row.at(5)) > 0) {
+                    return true;
+                }
+
+                if(budget_spent >= budget->limit) {
+                    return false;
+                }
+
+                budget_spent += budget->counts_bytes ? boost::lexical_cast<std::uint64_t>(_row.at(6)) : 1;
+                budgeted_objects.insert(_row.at(5));
+                return true;
+            };
+
+            auto& counters =
+                tiering_metrics::instance().transition(_group_name, _source_resource, _destination_resource);
+
+            // Violating objects are gathered here when more than one object is to be moved by each delay rule.
+            batch_collector<violating_object> batch{static_cast<std::size_t>(config_.data_movement_batch_size)};
+            const auto queue_batch = [&](RcComm& _batch_comm, const std::vector<violating_object>& _objects) {
+                if(_objects.empty()) {
+                    return;
+                }
+
+                queue_data_movement_batch(&_batch_comm,
+                                          _group_name,
+                                          _objects,
+                                          _source_resource,
+                                          _destination_resource,
+                                          get_verification_for_resc(&_batch_comm, _destination_resource),
+                                          preserve_replicas,
+                                          get_data_movement_parameters_for_resource(&_batch_comm, _source_resource));
+            };
+
+            // Violating objects are gathered into pages so that the migration scheduled flag is tested and set for
+            // many objects with a handful of catalog requests instead of several requests per object.
+            batch_collector<violating_object> page{static_cast<std::size_t>(config_.scheduling_page_size)};
+            const auto schedule_page = [&](RcComm& _page_comm, std::vector<violating_object> _objects) {
+                const auto number_of_objects = _objects.size();
+
+                if(preserve_replicas) {
+                    skip_objects_in_lower_tiers(&_page_comm, _objects, _partial_list);
+                }
+
+                if(_objects.empty()) {
+                    counters.objects_skipped += number_of_objects;
+                    return;
+                }
+
+                const auto failures = mark_objects_for_migration(&_page_comm, _objects);
+                counters.objects_skipped += number_of_objects - _objects.size() - failures;
+
+                // The sizes travel with the delay rules so that the data movement does not have to look them up.
+                set_data_sizes_for_objects(&_page_comm, _objects, _source_resource);
+
+                const auto enqueue = [&](const violating_object& _object) {
+                    enqueue_data_movement(&_page_comm,
+                                          config_.instance_name,
+                                          _group_name,
+                                          _object.object_path,
+                                          _object.source_replica_number,
+                                          _source_resource,
+                                          _destination_resource,
+                                          get_verification_for_resc(&_page_comm, _destination_resource),
+                                          preserve_replicas,
+                                          get_data_movement_parameters_for_resource(&_page_comm, _source_resource),
+                                          _object.data_size);
+                };
+
+                if(batch.batch_size() > 1) {
+                    // Large objects get a delay rule of their own so that a batch of small objects is never stuck
+                    // behind one, and so the delay server can run them side by side.
+                    for(auto& o : _objects) {
+                        if(o.data_size && *o.data_size >= config_.large_object_size_in_bytes) {
+                            enqueue(o);
+                        }
+                        else {
+                            queue_batch(_page_comm, batch.add(std::move(o)));
+                        }
+                    }
+                }
+                else {
+                    for(const auto& o : _objects) {
+                        enqueue(o);
+                    }
+                }
+
+                if(failures > 0) {
+                    THROW(
+                        SYS_INVALID_INPUT_PARAM,
+                        boost::format("failed to set migration scheduled flag for [%d] objects on resource [%s]") %
+                        failures %
+                        _source_resource);
+                }
+            };
 
             for(const auto& q_itr : query_list) {
-                const auto violating_query_type =
-#if IRODS_VERSION_INTEGER < 5000090
-                    query<rcComm_t>::convert_string_to_query_type(q_itr.second);
-#else
-                    query<rcComm_t>::string_to_query_type(q_itr.second);
-#endif
-                const auto& violating_query_string = q_itr.first;
+                const auto& violating_query_type   = q_itr.query_type;
+                const auto& violating_query_string = q_itr.query_string;
+                auto number_of_columns_expected = number_of_columns_required_from_query;
+                if(q_itr.selects_data_id) {
+                    number_of_columns_expected = q_itr.eviction_order.empty() ? number_of_columns_from_default_query
+                                                                              : number_of_columns_from_ordered_query;
+                }
+
+                // Progress through a resumable query, used to position the cursor for the next tiering pass.
+                std::atomic<uint32_t> rows_returned{0};
+                std::atomic<uint64_t> last_data_id{0};
+
                 auto job = [&](const result_row& _results) {
                     rodsLog(
                         config_.data_transfer_log_level_value,
-                        "found %ld objects for resc [%s] with query [%s] type [%d]",
+                        "found %ld objects for resc [%s] with query [%s] type [%s]",
                         _results.size(),
                         _source_resource.c_str(),
                         violating_query_string.c_str(),
-                        violating_query_type);
+                        violating_query_type.c_str());
                     if(_results.size() == 0) {
                         return;
                     }
 
                     // Log an error and continue if the violating query does not return exactly 5 items:
                     // DATA_NAME, COLL_NAME, USER_NAME, USER_ZONE, DATA_REPL_NUM
-                    if (_results.size() != number_of_columns_required_from_query) {
+                    if (_results.size() != number_of_columns_expected) {
                         rodsLog(LOG_ERROR,
                                 fmt::format("Query on resource [{}] returned [{}] columns. Violating queries must "
                                             "select these 5 columns in order: [DATA_NAME, COLL_NAME, USER_NAME, "
@@ -625,6 +1162,14 @@ namespace irods {
                         return;
                     }
 
+                    if (q_itr.resumable) {
+                        ++rows_returned;
+
+                        const auto data_id = boost::lexical_cast<uint64_t>(_results[5]);
+                        auto previous = last_data_id.load();
+                        while (previous < data_id && !last_data_id.compare_exchange_weak(previous, data_id)) {}
+                    }
+
                     auto object_path = _results[1]; // coll name
                     const auto& vps  = get_virtual_path_separator();
                     if( !boost::ends_with(object_path, vps)) {
@@ -632,45 +1177,201 @@ namespace irods {
                     }
                     object_path += _results[0]; // data name
 
-                    {
-                        // An irods::query_processor concurrently executes this function for each returned result. Each
-                        // instance refers to the same object_is_processed instance. So, we need a lock here to protect
-                        // against concurrent accesses of the object_is_processed map.
-                        const std::lock_guard object_is_processed_lock{object_is_processed_mutex};
+                    // The scheduling threads concurrently execute this function for each returned result. The set
+                    // is safe for concurrent use and only locks the stripe which holds the key.
+                    const auto object_key = q_itr.selects_data_id ? boost::lexical_cast<uint64_t>(_results[5])
+                                                                  : data_id_set::hash_logical_path(object_path);
+                    ++counters.objects_scanned;
+                    if (!object_is_processed.insert(object_key)) {
+                        ++counters.objects_skipped;
+                        return;
+                    }
+
+                    auto conn = connection_pool_->get_connection();
+                    RcComm& comm = static_cast<RcComm&>(conn);
 
-                        if (std::end(object_is_processed) != object_is_processed.find(object_path)) {
-                            return;
+                    try {
+                        schedule_page(comm, page.add({object_path, _results[4]}));
+                    }
+                    catch (const irods::exception& _e) {
+                        // Do not hand a broken connection to the next worker.
+                        if (storage_tiering_connection_pool::is_connection_error(_e.code())) {
+                            conn.invalidate();
                         }
 
-                        object_is_processed[object_path] = 1;
+                        throw;
                     }
 
-                    irods::experimental::client_connection conn;
-                    RcComm& comm = static_cast<RcComm&>(conn);
+                }; // job
+
+                try {
+                    // Each row is handed to the plugin's scheduling threads as it is read. The group only tracks
+                    // the rows of this query, so other tier transitions may share the threads in the meantime.
+                    task_group scheduling{executors_->scheduling};
+                    {
+                        // Only paging through the violating query counts against the catalog query budget.
+                        catalog_query_slots_->acquire();
+                        const auto release_slot = irods::at_scope_exit{[this] { catalog_query_slots_->release(); }};
+
+                        std::size_t rows_read = 0;
+                        const auto admit = [&](const result_row& _row) {
+                            if(!within_budget(q_itr, _row)) {
+                                return false;
+                            }
+
+                            scheduling.post([&job, _row] { job(_row); });
+                            return true;
+                        };
+
+                        // Objects moved with their replicas preserved keep matching the violating query, and an
+                        // ordered query returns the oldest of them first. They are dropped a page at a time before
+                        // they are admitted, so that they never spend the budget of the objects which can be moved.
+                        const bool skip_before_admitting = budget && !q_itr.eviction_order.empty() && preserve_replicas;
+                        std::vector<result_row> unadmitted;
+                        const auto admit_page = [&] {
+                            if(unadmitted.empty()) {
+                                return true;
+                            }
+
+                            std::vector<violating_object> objects;
+                            objects.reserve(unadmitted.size());
+                            for(const auto& row : unadmitted) {
+                                objects.push_back({make_logical_path(row[1], row[0]), row[4], std::nullopt});
+                            }
+
+                            skip_objects_in_lower_tiers(_comm, objects, _partial_list);
+
+                            std::set<std::string> movable;
+                            for(auto& o : objects) {
+                                movable.insert(std::move(o.object_path));
+                            }
+
+                            const auto rows = std::move(unadmitted);
+                            unadmitted.clear();
+                            for(const auto& row : rows) {
+                                if(movable.count(make_logical_path(row[1], row[0])) > 0 && !admit(row)) {
+                                    return false;
+                                }
+                            }
+
+                            return true;
+                        };
+
+                        const auto post = [&](const result_row& _row) {
+                            if(!skip_before_admitting) {
+                                return admit(_row);
+                            }
+
+                            unadmitted.push_back(_row);
+                            return unadmitted.size() < static_cast<std::size_t>(config_.scheduling_page_size) ||
+                                   admit_page();
+                        };
+
+                        if(q_itr.index_pass && !q_itr.index_pass->full_scan) {
+                            // Candidates from the index are only scheduled if the catalog agrees that they violate
+                            // the policy. The IN conditions match a superset of the candidates.
+                            for(const auto& chunk : make_logical_path_query_chunks(q_itr.index_pass->candidates)) {
+                                const std::set<std::string> candidates{
+                                    std::begin(chunk.logical_paths), std::end(chunk.logical_paths)};
+                                const auto chunk_query_string = fmt::format(
+                                    "{} and COLL_NAME in ({}) and DATA_NAME in ({})",
+                                    violating_query_string,
+                                    chunk.collection_names,
+                                    chunk.data_names);
+                                catalog_->for_each_row(
+                                    _comm, chunk_query_string, 0, {}, [&](const result_row& _row) {
+                                        if(candidates.count(make_logical_path(_row[1], _row[0])) > 0) {
+                                            ++rows_read;
+                                            post(_row);
+                                        }
+
+                                        return true;
+                                    });
+                            }
+                        }
+                        else {
+                            if(eviction_order::score == q_itr.eviction_order) {
+                                std::vector<result_row> rows;
+                                catalog_->for_each_row(
+                                    _comm,
+                                    violating_query_string,
+                                    query_limit,
+                                    violating_query_type,
+                                    [&rows](const result_row& _row) {
+                                        rows.push_back(_row);
+                                        return true;
+                                    });
+
+                                rows_read = rows.size();
+                                sort_by_eviction_score(rows);
+                                for(const auto& row : rows) {
+                                    if(!post(row)) {
+                                        break;
+                                    }
+                                }
+                                admit_page();
+                            }
+                            else {
+                                // Stop reading as soon as the budget is spent. The remaining rows are the objects
+                                // least worth moving.
+                                catalog_->for_each_row(
+                                    _comm,
+                                    violating_query_string,
+                                    query_limit,
+                                    violating_query_type,
+                                    [&](const result_row& _row) {
+                                        ++rows_read;
+                                        return post(_row);
+                                    });
+                                admit_page();
+                            }
+                        }
+
+                        if(0 == rows_read) {
+                            THROW(CAT_NO_ROWS_FOUND, "violating query returned no results");
+                        }
 
-                    if(preserve_replicas) {
-                        if (skip_object_in_lower_tier(&comm, object_path, _partial_list)) {
-                            return;
+                        if(budget && budget_spent >= budget->limit) {
+                            rodsLog(
+                                config_.data_transfer_log_level_value,
+                                "eviction budget of [%llu] %s for resc [%s] has been spent",
+                                static_cast<unsigned long long>(budget->limit),
+                                budget->counts_bytes ? "bytes" : "objects",
+                                _source_resource.c_str());
                         }
                     }
+                    auto errors = scheduling.wait();
 
-                    queue_data_movement(&comm,
-                                        config_.instance_name,
-                                        _group_name,
-                                        object_path,
-                                        _results[4],
-                                        _source_resource,
-                                        _destination_resource,
-                                        get_verification_for_resc(&comm, _destination_resource),
-                                        get_preserve_replicas_for_resc(&comm, _source_resource),
-                                        get_data_movement_parameters_for_resource(&comm, _source_resource));
+                    // Schedule whatever did not fill a complete page or batch. The scheduling threads are finished
+                    // with this query, so the connection driving the pass is free to use here.
+                    try {
+                        schedule_page(*_comm, page.take_remaining());
+                    }
+                    catch(const irods::exception& _e) {
+                        errors.emplace_back(_e.code(), _e.client_display_what());
+                    }
 
-                }; // job
+                    try {
+                        queue_batch(*_comm, batch.take_remaining());
+                    }
+                    catch(const irods::exception& _e) {
+                        errors.emplace_back(_e.code(), _e.client_display_what());
+                    }
+
+                    // The cursor only moves once every object read by this pass has been scheduled. If any of them
+                    // failed, the next pass reads the same objects again rather than skipping past them.
+                    if(q_itr.resumable && errors.empty()) {
+                        // A short page means the end of the violating objects was reached, so the next pass
+                        // starts over from the beginning.
+                        set_violating_query_cursor_for_resource(
+                            _comm, _source_resource, rows_returned < query_limit ? 0 : last_data_id.load());
+                    }
+
+                    // Access times in the window are read from the index again if any of them were not scheduled.
+                    if(q_itr.index_pass && errors.empty()) {
+                        complete_access_time_index_pass(_source_resource, *q_itr.index_pass);
+                    }
 
-                try {
-                    irods::query_processor<rcComm_t> qp(violating_query_string, job, query_limit, violating_query_type);
-                    auto future = qp.execute(thread_pool, *_comm);
-                    auto errors = future.get();
                     if(errors.size() > 0) {
                         for(auto& e : errors) {
                             rodsLog(
@@ -691,12 +1392,25 @@ namespace irods {
                 catch(const exception& _e) {
                     // if nothing of interest is found, thats not an error
                     if(CAT_NO_ROWS_FOUND == _e.code()) {
+                        if(q_itr.resumable) {
+                            try {
+                                set_violating_query_cursor_for_resource(_comm, _source_resource, 0);
+                            }
+                            catch(const exception& _cursor_error) {
+                                irods::log(_cursor_error);
+                            }
+                        }
+
+                        if(q_itr.index_pass) {
+                            complete_access_time_index_pass(_source_resource, *q_itr.index_pass);
+                        }
+
                         rodsLog(
                             config_.data_transfer_log_level_value,
-                            "no object found resc [%s] with query [%s] type [%d]",
+                            "no object found resc [%s] with query [%s] type [%s]",
                             _source_resource.c_str(),
                             violating_query_string.c_str(),
-                            violating_query_type);
+                            violating_query_type.c_str());
 
                         continue;
                     }
@@ -705,6 +1419,14 @@ namespace irods {
                     }
                 }
             } // for qstr
+
+            rodsLog(
+                config_.data_transfer_log_level_value,
+                "processed [%lu] objects for resc [%s] - deduplication used [%lu] bytes with [%lu] contended locks",
+                object_is_processed.size(),
+                _source_resource.c_str(),
+                object_is_processed.memory_usage(),
+                object_is_processed.contended_lock_acquisitions());
         }
         catch(const std::out_of_range& _e) {
             THROW(
@@ -714,6 +1436,232 @@ namespace irods {
         }
     } // migrate_violating_data_objects
 
+    auto storage_tiering::plan_violating_data_objects(
+        rcComm_t*              _comm,
+        const tier_transition& _transition,
+        std::ostream*          _candidates) -> nlohmann::json {
+        using result_row = std::vector<std::string>;
+        using clock_type = std::chrono::steady_clock;
+
+        constexpr auto number_of_columns_required_from_query = 5;
+
+        const auto& source_resource = _transition.source_resource;
+        const bool preserve_replicas = get_preserve_replicas_for_resc(_comm, source_resource);
+        const auto object_limit      = get_object_limit_for_resource(_comm, source_resource);
+        const auto budget            = get_eviction_budget_for_resource(_comm, source_resource);
+        const auto leaf_id_list      = catalog_->leaf_id_list(source_resource);
+
+        // Neither the cursor nor the access time index is consulted, so the plan covers every violating object.
+        const auto query_list = get_violating_queries_for_resource(_comm, source_resource, 0, {}, false);
+
+        // Every catalog request made for the plan is timed so that the estimate reflects the catalog as it is now.
+        std::uint64_t catalog_requests = 0;
+        clock_type::duration catalog_time{};
+        const auto for_each_row = [&](const std::string& _query_string,
+                                      const std::string& _query_type,
+                                      const auto&        _on_row) {
+            const auto start = clock_type::now();
+            std::uint64_t rows = 0;
+            catalog_->for_each_row(_comm, _query_string, 0, _query_type, [&](const result_row& _row) {
+                ++rows;
+                _on_row(_row);
+                return true;
+            });
+
+            catalog_time += clock_type::now() - start;
+            catalog_requests += std::max<std::uint64_t>((rows + MAX_SQL_ROWS - 1) / MAX_SQL_ROWS, 1);
+        };
+
+        const auto write_candidate = [&](const std::string& _object_path,
+                                         const std::string& _replica_number,
+                                         std::uint64_t      _data_size) {
+            if(_candidates) {
+                *_candidates << nlohmann::json{{"group", _transition.group},
+                                               {"source", source_resource},
+                                               {"destination", _transition.destination_resource},
+                                               {"object_path", _object_path},
+                                               {"replica_number", _replica_number},
+                                               {"data_size", _data_size}}.dump()
+                             << '\n';
+            }
+        };
+
+        size_distribution sizes;
+        std::uint64_t objects           = 0;
+        std::uint64_t bytes             = 0;
+        std::uint64_t large_objects     = 0;
+        std::uint64_t minimum_data_size = 0;
+        std::uint64_t maximum_data_size = 0;
+
+        const bool aggregated = 1 == query_list.size() && query_list.front().selects_data_id;
+        if(aggregated) {
+            // The default query is answered by the catalog with aggregates over its conditions. Each violating
+            // replica on the source resource is counted.
+            const auto& query_string = query_list.front().query_string;
+            const auto conditions = query_string.substr(query_string.find(" where ") + 7);
+
+            const auto aggregate = [&](const std::string& _columns, const std::string& _extra_conditions) {
+                // Aggregates over no rows are treated as zero.
+                result_row result(4);
+                for_each_row(fmt::format("select {} where {}{}", _columns, conditions, _extra_conditions),
+                             "",
+                             [&result](const result_row& _row) { result = _row; });
+                return result;
+            };
+
+            const auto totals = aggregate("COUNT(DATA_ID), SUM(DATA_SIZE), MIN(DATA_SIZE), MAX(DATA_SIZE)", "");
+            objects           = aggregate_to_count(totals.at(0));
+            bytes             = aggregate_to_count(totals.at(1));
+            minimum_data_size = aggregate_to_count(totals.at(2));
+            maximum_data_size = aggregate_to_count(totals.at(3));
+
+            if(objects > 0) {
+                for(std::size_t i = 0; i < sizes.objects.size(); ++i) {
+                    auto range = fmt::format(" and DATA_SIZE >= '{}'", size_distribution::lower_bound(i));
+                    if(i < size_distribution::upper_bounds.size()) {
+                        range += fmt::format(" and DATA_SIZE < '{}'", size_distribution::upper_bounds[i]);
+                    }
+
+                    const auto in_range = aggregate("COUNT(DATA_ID), SUM(DATA_SIZE)", range);
+                    sizes.objects[i] = aggregate_to_count(in_range.at(0));
+                    sizes.bytes[i]   = aggregate_to_count(in_range.at(1));
+                }
+
+                large_objects = aggregate_to_count(aggregate(
+                    "COUNT(DATA_ID)",
+                    fmt::format(" and DATA_SIZE >= '{}'", config_.large_object_size_in_bytes)).at(0));
+            }
+
+            if(_candidates && objects > 0) {
+                for_each_row(
+                    fmt::format("select DATA_NAME, COLL_NAME, DATA_REPL_NUM, DATA_SIZE where {}", conditions),
+                    "",
+                    [&](const result_row& _row) {
+                        write_candidate(make_logical_path(_row[1], _row[0]),
+                                        _row[2],
+                                        aggregate_to_count(_row[3]));
+                    });
+            }
+        }
+        else {
+            // Custom queries cannot be rewritten as aggregates, so their rows are read and the sizes of the
+            // violating replicas are looked up in chunks, as the scheduling threads would.
+            data_id_set object_is_counted;
+            std::vector<violating_object> violating_objects;
+            for(const auto& q : query_list) {
+                for_each_row(q.query_string, q.query_type, [&](const result_row& _row) {
+                    if(_row.size() < number_of_columns_required_from_query) {
+                        return;
+                    }
+
+                    auto object_path = make_logical_path(_row[1], _row[0]);
+                    if(object_is_counted.insert(data_id_set::hash_logical_path(object_path))) {
+                        violating_objects.push_back({std::move(object_path), _row[4]});
+                    }
+                });
+            }
+
+            std::map<std::string, std::uint64_t> data_sizes;
+            std::vector<std::string> object_paths;
+            object_paths.reserve(violating_objects.size());
+            for(const auto& o : violating_objects) {
+                object_paths.push_back(o.object_path);
+            }
+
+            for(const auto& chunk : make_logical_path_query_chunks(object_paths)) {
+                for_each_row(
+                    fmt::format("select COLL_NAME, DATA_NAME, DATA_REPL_NUM, DATA_SIZE where COLL_NAME in ({}) and "
+                                "DATA_NAME in ({}) and DATA_RESC_ID in ({})",
+                                chunk.collection_names,
+                                chunk.data_names,
+                                leaf_id_list),
+                    "",
+                    [&data_sizes](const result_row& _row) {
+                        data_sizes.try_emplace(
+                            fmt::format("{}#{}", make_logical_path(_row[0], _row[1]), _row[2]),
+                            aggregate_to_count(_row[3]));
+                    });
+            }
+
+            for(const auto& o : violating_objects) {
+                // The replica may have been moved or trimmed since the query was read.
+                const auto s = data_sizes.find(fmt::format("{}#{}", o.object_path, o.source_replica_number));
+                if(std::end(data_sizes) == s) {
+                    continue;
+                }
+
+                const auto data_size = s->second;
+                minimum_data_size = 0 == objects ? data_size : std::min(minimum_data_size, data_size);
+                maximum_data_size = std::max(maximum_data_size, data_size);
+                ++objects;
+                bytes += data_size;
+                if(data_size >= static_cast<std::uint64_t>(config_.large_object_size_in_bytes)) {
+                    ++large_objects;
+                }
+
+                sizes.add(data_size);
+                write_candidate(o.object_path, o.source_replica_number, data_size);
+            }
+        }
+
+        // A byte budget cannot be applied without reading the objects in eviction order, so only the object limit
+        // and an object budget cap what a single pass would schedule.
+        auto objects_per_pass = objects;
+        if(object_limit > 0) {
+            objects_per_pass = std::min<std::uint64_t>(objects_per_pass, object_limit);
+        }
+
+        if(budget && !budget->counts_bytes) {
+            objects_per_pass = std::min(objects_per_pass, budget->limit);
+        }
+
+        // A pass reads the violating query on the thread driving it. For each page of scheduled objects, a
+        // scheduling thread looks up the migration flags, the lower tier replicas when they matter, and the data
+        // sizes. Then it sets the flag of each object and queues the delay rules.
+        const auto batch_size = static_cast<std::uint64_t>(std::max(config_.data_movement_batch_size, 1));
+        const auto page_size  = static_cast<std::uint64_t>(std::max(config_.scheduling_page_size, 1));
+        const auto threads    = static_cast<std::uint64_t>(std::max(config_.number_of_scheduling_threads, 1));
+
+        const auto query_pages = (objects_per_pass + MAX_SQL_ROWS - 1) / MAX_SQL_ROWS;
+        const auto pages = (objects_per_pass + page_size - 1) / page_size;
+        const auto lookups_per_page = 2 + (preserve_replicas ? 1 : 0);
+        auto delay_rules = objects_per_pass;
+        if(batch_size > 1) {
+            const auto large = std::min(large_objects, objects_per_pass);
+            delay_rules = large + (objects_per_pass - large + batch_size - 1) / batch_size;
+        }
+
+        const auto scheduling_requests = pages * lookups_per_page + objects_per_pass + delay_rules;
+        const auto round_trip_seconds =
+            0 == catalog_requests ? 0.0
+                                  : std::chrono::duration<double>{catalog_time}.count() / catalog_requests;
+
+        nlohmann::json eviction_budget_json;
+        if(budget) {
+            eviction_budget_json = {{"limit", budget->limit}, {"unit", budget->counts_bytes ? "bytes" : "objects"}};
+        }
+
+        return {{"group", _transition.group},
+                {"source", source_resource},
+                {"destination", _transition.destination_resource},
+                {"aggregated", aggregated},
+                {"objects", objects},
+                {"bytes", bytes},
+                {"minimum_data_size", minimum_data_size},
+                {"maximum_data_size", maximum_data_size},
+                {"large_objects", large_objects},
+                {"size_distribution", sizes.to_json()},
+                {"preserve_replicas", preserve_replicas},
+                {"object_limit", object_limit},
+                {"eviction_budget", eviction_budget_json},
+                {"objects_per_pass", objects_per_pass},
+                {"delay_rules_per_pass", delay_rules},
+                {"estimated_catalog_requests", query_pages + scheduling_requests},
+                {"catalog_round_trip_seconds", round_trip_seconds},
+                {"expected_scheduling_seconds",
+                 round_trip_seconds * (query_pages + static_cast<double>(scheduling_requests) / threads)}};
+    } // plan_violating_data_objects
+
     void storage_tiering::schedule_storage_tiering_policy(
         const std::string& _json,
         const std::string& _params) {
@@ -741,11 +1689,40 @@ namespace irods {
         const std::string& _verification_type,
         const bool         _preserve_replicas,
         const std::string& _data_movement_params) {
-        if (object_has_migration_metadata_flag(_comm, _object_path)) {
+        if (!mark_object_for_migration(_comm, _object_path)) {
             return;
         }
 
-        set_migration_metadata_flag_for_object(_comm, _object_path);
+        enqueue_data_movement(_comm,
+                              _plugin_instance_name,
+                              _group_name,
+                              _object_path,
+                              _source_replica_number,
+                              _source_resource,
+                              _destination_resource,
+                              _verification_type,
+                              _preserve_replicas,
+                              _data_movement_params,
+                              std::nullopt);
+    } // queue_data_movement
+
+    void storage_tiering::enqueue_data_movement(
+        rcComm_t*          _comm,
+        const std::string& _plugin_instance_name,
+        const std::string& _group_name,
+        const std::string& _object_path,
+        const std::string& _source_replica_number,
+        const std::string& _source_resource,
+        const std::string& _destination_resource,
+        const std::string& _verification_type,
+        const bool                       _preserve_replicas,
+        const std::string&               _data_movement_params,
+        const std::optional<rodsLong_t>& _data_size) {
+        const movement_trace trace{config_.movement_trace_log_path,
+                                   movement_trace::make_movement_id(),
+                                   {{"group", _group_name},
+                                    {"source", _source_resource},
+                                    {"destination", _destination_resource}}};
 
         nlohmann::json rule_obj =
         {
@@ -754,6 +1731,8 @@ namespace irods {
                 {
                     {"rule-engine-operation",     policy::data_movement}
                   , {"rule-engine-instance-name", _plugin_instance_name}
+                  , {"movement-id",               trace.movement_id()}
+                  , {"enqueued-at",               movement_trace::to_microseconds(movement_trace::clock_type::now())}
                   , {"group-name",                _group_name}
                   , {"object-path",               _object_path}
                   , {"source-replica-number",     _source_replica_number}
@@ -761,37 +1740,19 @@ namespace irods {
                   , {"destination-resource",      _destination_resource}
                   , {"preserve-replicas",         _preserve_replicas}
                   , {"verification-type",         _verification_type}
+                  , {"data-movement-mode",        get_data_movement_mode_for_resc(_comm, _source_resource)}
                   , {"delay_conditions",          _data_movement_params}
                 }
             }
          };
 
-        execMyRuleInp_t exec_inp{};
-        msParamArray_t* out_arr{};
-        // Capture out_arr pointer by reference because it is still nullptr at this point.
-        const auto free_inputs_and_outputs = irods::at_scope_exit{[&exec_inp, &out_arr] {
-            clearKeyVal(&exec_inp.condInput);
-
-            if (exec_inp.inpParamArray) {
-                // The second parameter with a value of 1 instructs the function to free the "inOutStruct".
-                clearMsParamArray(exec_inp.inpParamArray, 1);
-                std::free(exec_inp.inpParamArray);
-            }
-
-            if (out_arr) {
-                // The second parameter with a value of 1 instructs the function to free the "inOutStruct".
-                clearMsParamArray(out_arr, 1);
-                std::free(out_arr);
-            }
-        }};
-
-        rstrcpy(exec_inp.myRule, rule_obj.dump().c_str(), META_STR_LEN);
-        addKeyVal(
-            &exec_inp.condInput
-          , irods::KW_CFG_INSTANCE_NAME
-          , "irods_rule_engine_plugin-cpp_default_policy-instance");
+        if(_data_size) {
+            rule_obj["parameters"]["data-size"] = *_data_size;
+        }
 
-        auto err = rcExecMyRule(_comm, &exec_inp, &out_arr);
+        const auto enqueue_start = movement_trace::clock_type::now();
+        const auto err = enqueue_rule(_comm, rule_obj);
+        trace.record("enqueue", _object_path, enqueue_start, movement_trace::clock_type::now(), err < 0);
 
         if(err < 0) {
             THROW(
@@ -802,6 +1763,8 @@ namespace irods {
                 _destination_resource);
         }
 
+        ++tiering_metrics::instance().transition(_group_name, _source_resource, _destination_resource).objects_queued;
+
         rodsLog(
             config_.data_transfer_log_level_value,
             "irods::storage_tiering migrating [%s] from [%s] to [%s]",
@@ -809,32 +1772,132 @@ namespace irods {
             _source_resource.c_str(),
             _destination_resource.c_str());
 
-    } // queue_data_movement
+    } // enqueue_data_movement
+
+    void storage_tiering::queue_data_movement_batch(
+        rcComm_t*                             _comm,
+        const std::string&                    _group_name,
+        const std::vector<violating_object>&  _objects,
+        const std::string&                    _source_resource,
+        const std::string&                    _destination_resource,
+        const std::string&                    _verification_type,
+        const bool                            _preserve_replicas,
+        const std::string&                    _data_movement_params) {
+        nlohmann::json rule_obj =
+        {
+            {"policy_to_invoke", "irods_policy_enqueue_rule"}
+          , {"parameters",
+                {
+                    {"rule-engine-operation",     policy::data_movement}
+                  , {"rule-engine-instance-name", config_.instance_name}
+                  , {"movement-id",               movement_trace::make_movement_id()}
+                  , {"enqueued-at",               movement_trace::to_microseconds(movement_trace::clock_type::now())}
+                  , {"group-name",                _group_name}
+                  , {"objects",                   nlohmann::json::array()}
+                  , {"source-resource",           _source_resource}
+                  , {"destination-resource",      _destination_resource}
+                  , {"preserve-replicas",         _preserve_replicas}
+                  , {"verification-type",         _verification_type}
+                  , {"data-movement-mode",        get_data_movement_mode_for_resc(_comm, _source_resource)}
+                  , {"delay_conditions",          _data_movement_params}
+                }
+            }
+         };
+
+        auto& parameters = rule_obj.at("parameters");
+        auto& objects = parameters.at("objects");
+
+        const auto enqueue = [&] {
+            // Each delay rule is a movement of its own. The stamps keep their size, so the rule still fits.
+            const movement_trace trace{config_.movement_trace_log_path,
+                                       movement_trace::make_movement_id(),
+                                       {{"group", _group_name},
+                                        {"source", _source_resource},
+                                        {"destination", _destination_resource},
+                                        {"objects", objects.size()}}};
+            parameters["movement-id"] = trace.movement_id();
+            parameters["enqueued-at"] = movement_trace::to_microseconds(movement_trace::clock_type::now());
+
+            const auto enqueue_start = movement_trace::clock_type::now();
+            const auto err = enqueue_rule(_comm, rule_obj);
+            trace.record("enqueue", {}, enqueue_start, movement_trace::clock_type::now(), err < 0);
+
+            if(err < 0) {
+                // Nothing will move these objects, so make them eligible for the next tiering pass again.
+                for(const auto& o : objects) {
+                    try {
+                        unset_migration_metadata_flag_for_object(_comm, o.at("object-path").get<std::string>());
+                    }
+                    catch(const irods::exception& _e) {
+                        irods::log(_e);
+                    }
+                }
+
+                THROW(
+                    err,
+                    boost::format("queue data movement failed for [%d] objects from [%s] to [%s]") %
+                    objects.size() %
+                    _source_resource %
+                    _destination_resource);
+            }
+
+            auto& counters =
+                tiering_metrics::instance().transition(_group_name, _source_resource, _destination_resource);
+            counters.objects_queued += objects.size();
+
+            rodsLog(
+                config_.data_transfer_log_level_value,
+                "irods::storage_tiering migrating [%lu] objects from [%s] to [%s]",
+                objects.size(),
+                _source_resource.c_str(),
+                _destination_resource.c_str());
+        };
+
+        for(const auto& o : _objects) {
+            objects.push_back({{"object-path", o.object_path}, {"source-replica-number", o.source_replica_number}});
+            if(o.data_size) {
+                objects.back()["data-size"] = *o.data_size;
+            }
+
+            // The rule text must fit in the fixed-size buffer of execMyRuleInp_t, so a batch which has grown too
+            // large is split across as many delay rules as it takes.
+            if(objects.size() > 1 && rule_obj.dump().size() >= META_STR_LEN) {
+                auto overflow = objects.back();
+                objects.erase(objects.size() - 1);
+                enqueue();
+                objects = nlohmann::json::array({std::move(overflow)});
+            }
+        }
+
+        if(!objects.empty()) {
+            enqueue();
+        }
+    } // queue_data_movement_batch
+
+    int storage_tiering::enqueue_rule(
+        rcComm_t*             _comm,
+        const nlohmann::json& _rule) {
+        const tiering_metrics::scoped_timer timer{
+            tiering_metrics::instance().histogram(tiering_metrics::operation::queue_data_movement)};
+
+        return catalog_->execute_rule(_comm, _rule.dump());
+
+    } // enqueue_rule
 
     std::string storage_tiering::get_replica_number_for_resource(
         rcComm_t*          _comm,
         const std::string& _object_path,
         const std::string& _resource_name) {
-        boost::filesystem::path p{irods::single_quotes_to_hex(_object_path)};
-        std::string coll_name = p.parent_path().string();
-        std::string data_name = p.filename().string();
-
-        std::string leaf_ids = get_leaf_resources_string(_resource_name);
-        const auto qstr =
-            fmt::format("select DATA_REPL_NUM where DATA_NAME = '{}' and COLL_NAME = '{}' and DATA_RESC_ID in ({})",
-                        data_name,
-                        coll_name,
-                        leaf_ids);
+        const auto leaf_ids = catalog_->leaf_id_list(_resource_name);
+        auto replica_number = catalog_->replica_number(_comm, _object_path, leaf_ids);
 
-        query<rcComm_t> qobj{_comm, qstr};
-
-        if(qobj.size() == 0) {
+        if(!replica_number) {
             THROW(
                 CAT_NO_ROWS_FOUND,
                 "failed to fetch user name and replica number");
         }
 
-        return qobj.front()[0];
+        return std::move(*replica_number);
 
     } // get_replica_number_for_resource
 
@@ -842,25 +1905,15 @@ namespace irods {
         rcComm_t*          _comm,
         const std::string& _attribute_name,
         const std::string& _object_path) {
-        boost::filesystem::path p{irods::single_quotes_to_hex(_object_path)};
-        std::string data_name = p.filename().string();
-        std::string coll_name = p.parent_path().string();
-
-        const auto qstr = fmt::format(
-            "select META_DATA_ATTR_VALUE where DATA_NAME = '{}' and COLL_NAME = '{}' and META_DATA_ATTR_NAME = '{}'",
-            data_name,
-            coll_name,
-            _attribute_name);
-
-        query<rcComm_t> qobj{_comm, qstr};
+        const auto avus = catalog_->data_object_metadata(_comm, _object_path, _attribute_name);
 
-        if(qobj.size() == 0) {
+        if(avus.empty()) {
             THROW(
                 CAT_NO_ROWS_FOUND,
                 "failed to fetch group name by object and resource");
         }
 
-        return qobj.front()[0];
+        return avus.front().first;
 
     } // get_group_name_for_object
 
@@ -926,9 +1979,9 @@ namespace irods {
 
         std::string partial_list{};
         for(; _itr != _end; ++_itr) {
-            // get_leaf_resources_string pops off the trailing comma, so we must append it here for each partial list
-            // being concatenated.
-            partial_list += get_leaf_resources_string(_itr->second) + ",";
+            // The leaf ID lists do not end with a comma, so we must append it here for each partial list being
+            // concatenated.
+            partial_list += catalog_->leaf_id_list(_itr->second) + ",";
         }
 
         // Pop off the trailing comma to ensure a valid query.
@@ -940,62 +1993,192 @@ namespace irods {
 
     void storage_tiering::apply_policy_for_tier_group(
         const std::string& _group) {
+        apply_policy_for_tier_groups({_group});
+    } // apply_policy_for_tier_group
 
-        resource_index_map rescs = get_resource_map_for_group(
-                                             comm_,
-                                             _group);
-        if(rescs.empty()) {
-            rodsLog(
-                LOG_ERROR,
-                "%s :: no resources found for group [%s]",
-                __FUNCTION__,
-                _group.c_str());
+    auto storage_tiering::make_tier_transitions(
+        const std::vector<std::string>& _groups,
+        std::vector<std::string>&       _resource_names) -> std::vector<std::vector<tier_transition>> {
+        // Each transition is computed up front so that the partial list of lower tiers is derived from the complete
+        // resource map for its group, regardless of the order in which the transitions finish.
+        std::vector<std::vector<tier_transition>> transitions_by_group;
+
+        for(const auto& group : _groups) {
+            resource_index_map rescs = get_resource_map_for_group(
+                                                 comm_,
+                                                 group);
+            if(rescs.empty()) {
+                rodsLog(
+                    LOG_ERROR,
+                    "%s :: no resources found for group [%s]",
+                    __FUNCTION__,
+                    group.c_str());
+                continue;
+            }
+
+            auto& transitions = transitions_by_group.emplace_back();
+
+            auto resc_itr = rescs.begin();
+            for( ; resc_itr != rescs.end(); ++resc_itr) {
+                _resource_names.push_back(resc_itr->second);
+
+                auto next_itr = resc_itr;
+                ++next_itr;
+                if(rescs.end() == next_itr) {
+                    break;
+                }
+
+                transitions.push_back({group,
+                                       make_partial_list(resc_itr, rescs.end()),
+                                       resc_itr->second,
+                                       next_itr->second});
+            } // for resc
+        }
+
+        return transitions_by_group;
+    } // make_tier_transitions
+
+    void storage_tiering::apply_policy_for_tier_groups(
+        const std::vector<std::string>& _groups) {
+        std::vector<std::string> resource_names;
+        auto transitions_by_group = make_tier_transitions(_groups, resource_names);
+
+        if(resource_names.empty()) {
             return;
         }
 
-        auto resc_itr = rescs.begin();
-        for( ; resc_itr != rescs.end(); ++resc_itr) {
-            const auto partial_list{make_partial_list(resc_itr, rescs.end())};
-            auto next_itr = resc_itr;
-            ++next_itr;
-            if(rescs.end() == next_itr) {
-                break;
+        // The resource metadata cannot change in a way that matters during a pass, so load it once for all of the
+        // tier groups rather than asking the catalog again for every violating object. The snapshot is not modified
+        // while the transitions are running, so they may all read from it.
+        resource_metadata_ = make_resource_metadata_snapshot(comm_, resource_names);
+        const auto release_snapshot = irods::at_scope_exit{[this] {
+            rodsLog(
+                config_.data_transfer_log_level_value,
+                "irods::storage_tiering :: [%lu] catalog queries avoided by resource metadata snapshot",
+                resource_metadata_->catalog_queries_avoided());
+            resource_metadata_.reset();
+
+            log_re::debug("apply_policy_for_tier_groups: [{}] scheduling threads busy, [{}] tasks queued, "
+                          "utilization [{:.2f}]",
+                          executors_->scheduling.busy_threads(),
+                          executors_->scheduling.queue_depth(),
+                          executors_->scheduling.utilization());
+        }};
+
+        // Interleave the groups so that the first transition of every group is started before the second
+        // transition of any group. A group with many tiers cannot hold back the others.
+        std::size_t most_transitions = 0;
+        for(const auto& transitions : transitions_by_group) {
+            most_transitions = std::max(most_transitions, transitions.size());
+        }
+
+        std::vector<tier_transition> schedule;
+        for(std::size_t tier = 0; tier < most_transitions; ++tier) {
+            for(auto& transitions : transitions_by_group) {
+                if(tier < transitions.size()) {
+                    schedule.push_back(std::move(transitions[tier]));
+                }
             }
+        }
+
+        const auto migrate = [this](RcComm& _comm, const tier_transition& _transition) {
             migrate_violating_data_objects(
-                comm_,
-                _group,
-                partial_list,
-                resc_itr->second,
-                next_itr->second);
+                &_comm,
+                _transition.group,
+                _transition.partial_list,
+                _transition.source_resource,
+                _transition.destination_resource);
+        };
+
+        if(config_.number_of_concurrent_tier_transitions <= 1 || schedule.size() <= 1) {
+            for(const auto& t : schedule) {
+                migrate(*comm_, t);
+            }
 
-        } // for resc
+            return;
+        }
 
-    } // apply_policy_for_tier_group
+        // Transitions run on the plugin's transition threads, which are separate from the scheduling threads
+        // that each transition waits on.
+        task_group transitions{executors_->transitions};
 
-    void storage_tiering::set_migration_metadata_flag_for_object(
-        rcComm_t*          _comm,
-        const std::string& _object_path) {
-        auto access_time = get_metadata_for_data_object(
-                               _comm,
-                               config_.access_time_attribute,
-                               _object_path);
+        for(const auto& t : schedule) {
+            transitions.post([&, t] {
+                // Each transition drives its violating queries over its own connection.
+                auto conn = connection_pool_->get_connection();
+
+                try {
+                    migrate(static_cast<RcComm&>(conn), t);
+                }
+                catch(const irods::exception& _e) {
+                    if(storage_tiering_connection_pool::is_connection_error(_e.code())) {
+                        conn.invalidate();
+                    }
+
+                    THROW(_e.code(), fmt::format("[{}] -> [{}] in group [{}]: {}",
+                                                 t.source_resource,
+                                                 t.destination_resource,
+                                                 t.group,
+                                                 _e.client_display_what()));
+                }
+            });
+        }
 
-        modAVUMetadataInp_t set_op{
-           "set",
-           "-d",
-           const_cast<char*>(_object_path.c_str()),
-           const_cast<char*>(config_.access_time_attribute.c_str()),
-           const_cast<char*>(access_time.c_str()),
-           const_cast<char*>(config_.migration_scheduled_flag.c_str())};
+        const auto errors = transitions.wait();
 
-        addKeyVal(&set_op.condInput, ADMIN_KW, "");
+        if(!errors.empty()) {
+            for(const auto& [code, msg] : errors) {
+                rodsLog(LOG_ERROR, "tier transition failed - [%d]::[%s]", code, msg.c_str());
+            }
 
-        if (const auto ec = rcModAVUMetadata(_comm, &set_op); ec < 0) {
-            const auto msg = fmt::format("{}: failed to set migration scheduled flag for [{}]", __func__, _object_path);
-            log_re::error(msg);
-            THROW(ec, msg);
+            THROW(
+                std::get<0>(errors.front()),
+                fmt::format("[{}] of [{}] tier transitions failed", errors.size(), schedule.size()));
+        }
+    } // apply_policy_for_tier_groups
+
+    auto storage_tiering::plan_policy_for_tier_groups(
+        const std::vector<std::string>& _groups,
+        const std::string&              _candidate_list_path) -> nlohmann::json {
+        std::vector<std::string> resource_names;
+        const auto transitions_by_group = make_tier_transitions(_groups, resource_names);
+
+        auto report = nlohmann::json{{"transitions", nlohmann::json::array()}};
+        if(resource_names.empty()) {
+            return report;
+        }
+
+        resource_metadata_ = make_resource_metadata_snapshot(comm_, resource_names);
+        const auto release_snapshot = irods::at_scope_exit{[this] { resource_metadata_.reset(); }};
+
+        std::ofstream candidates;
+        if(!_candidate_list_path.empty()) {
+            candidates.open(_candidate_list_path, std::ios::trunc);
+            if(!candidates) {
+                THROW(UNIX_FILE_OPEN_ERR - errno,
+                      fmt::format("failed to open candidate list [{}]", _candidate_list_path));
+            }
+        }
+
+        // A dry run is not expected to be fast, so the transitions are planned one after another over the
+        // connection of the caller rather than competing with tiering passes for the plugin's threads.
+        for(const auto& transitions : transitions_by_group) {
+            for(const auto& t : transitions) {
+                report["transitions"].push_back(
+                    plan_violating_data_objects(comm_, t, candidates.is_open() ? &candidates : nullptr));
+            }
+        }
+
+        if(candidates.is_open()) {
+            if(!candidates.flush()) {
+                THROW(UNIX_FILE_WRITE_ERR, fmt::format("failed to write candidate list [{}]", _candidate_list_path));
+            }
+
+            report["candidate_list_path"] = _candidate_list_path;
         }
-    } // set_migration_metadata_flag_for_object
+
+        return report;
+    } // plan_policy_for_tier_groups
 
     void storage_tiering::unset_migration_metadata_flag_for_object(
         rcComm_t*          _comm,
@@ -1004,17 +2187,9 @@ namespace irods {
                                _comm,
                                config_.access_time_attribute,
                                _object_path);
-        modAVUMetadataInp_t set_op{
-           "set",
-           "-d",
-           const_cast<char*>(_object_path.c_str()),
-           const_cast<char*>(config_.access_time_attribute.c_str()),
-           const_cast<char*>(access_time.c_str()),
-           nullptr};
-
-        addKeyVal(&set_op.condInput, ADMIN_KW, "");
-
-        if (const auto ec = rcModAVUMetadata(_comm, &set_op); ec < 0) {
+        if (const auto ec =
+                catalog_->set_data_object_metadata(_comm, _object_path, config_.access_time_attribute, access_time, {});
+            ec < 0) {
             const auto msg =
                 fmt::format("{}: failed to unset migration scheduled flag for [{}]", __func__, _object_path);
             log_re::error(msg);
@@ -1022,23 +2197,88 @@ namespace irods {
         }
     } // unset_migration_metadata_flag_for_object
 
-    bool storage_tiering::object_has_migration_metadata_flag(
+    bool storage_tiering::mark_object_for_migration(
         rcComm_t*          _comm,
         const std::string& _object_path) {
-        boost::filesystem::path p{irods::single_quotes_to_hex(_object_path)};
-        std::string coll_name = p.parent_path().string();
-        std::string data_name = p.filename().string();
+        std::vector<violating_object> objects{{_object_path, {}}};
+        if (mark_objects_for_migration(_comm, objects) > 0) {
+            THROW(
+                CAT_NO_ROWS_FOUND,
+                fmt::format("{}: failed to set migration scheduled flag for [{}]", __func__, _object_path));
+        }
+
+        return !objects.empty();
+    } // mark_object_for_migration
+
+    auto storage_tiering::mark_objects_for_migration(
+        rcComm_t*                      _comm,
+        std::vector<violating_object>& _objects) -> std::size_t {
+        if(_objects.empty()) {
+            return 0;
+        }
+
+        std::vector<std::string> object_paths;
+        object_paths.reserve(_objects.size());
+        for(const auto& o : _objects) {
+            object_paths.push_back(o.object_path);
+        }
+
+        // Fetch the access time AVU of the whole page with as few queries as the IN-lists allow.
+        std::map<std::string, std::pair<std::string, std::string>> access_times;
+        auto avus_by_object = catalog_->data_object_metadata(_comm, object_paths, config_.access_time_attribute);
+        for(auto& [object_path, avus] : avus_by_object) {
+            if(!avus.empty()) {
+                access_times.emplace(object_path, std::move(avus.back()));
+            }
+        }
+
+        std::size_t failures = 0;
+
+        const auto not_marked = [&](const violating_object& _object) {
+            const auto at = access_times.find(_object.object_path);
+            if(std::end(access_times) == at) {
+                log_re::error("{}: failed to set migration scheduled flag for [{}] - no [{}] metadata found",
+                              __func__,
+                              _object.object_path,
+                              config_.access_time_attribute);
+                ++failures;
+                return true;
+            }
 
-        const auto query_str = fmt::format("select META_DATA_ATTR_VALUE where META_DATA_ATTR_NAME = '{}' and "
-                                           "META_DATA_ATTR_UNITS = '{}' and DATA_NAME = '{}' and COLL_NAME = '{}'",
-                                           config_.access_time_attribute,
-                                           config_.migration_scheduled_flag,
-                                           data_name,
-                                           coll_name);
+            const auto& [access_time, units] = at->second;
+            if(units == config_.migration_scheduled_flag) {
+                return true;
+            }
 
-        query<rcComm_t> qobj{_comm, query_str, 1};
-        return qobj.size() > 0;
-    } // object_has_migration_metadata_flag
+            // The flag is set with a compare and set on the units read above. If another agent has set the flag
+            // since then, the change fails and the object is left to that agent, so each object is queued once.
+            if(const auto ec = catalog_->change_data_object_metadata_units(_comm,
+                                                                           _object.object_path,
+                                                                           config_.access_time_attribute,
+                                                                           access_time,
+                                                                           units,
+                                                                           config_.migration_scheduled_flag);
+               ec < 0) {
+                if(storage_tiering_connection_pool::is_connection_error(ec)) {
+                    THROW(ec, fmt::format("{}: failed to set migration scheduled flag for [{}]",
+                                          __func__, _object.object_path));
+                }
+
+                rodsLog(config_.data_transfer_log_level_value,
+                        "%s: skipping [%s] - access time metadata changed while setting migration scheduled flag [%d]",
+                        __func__,
+                        _object.object_path.c_str(),
+                        ec);
+                return true;
+            }
+
+            return false;
+        };
+
+        _objects.erase(std::remove_if(std::begin(_objects), std::end(_objects), not_marked), std::end(_objects));
+
+        return failures;
+    } // mark_objects_for_migration
 
     void storage_tiering::apply_tier_group_metadata_to_object(
         const std::string& _group_name,
@@ -1058,17 +2298,8 @@ namespace irods {
                                                         comm_,
                                                         _object_path,
                                                         _destination_resource);
-            modAVUMetadataInp_t set_op{
-                "set",
-                "-d",
-                const_cast<char*>(_object_path.c_str()),
-                const_cast<char*>(config_.group_attribute.c_str()),
-                const_cast<char*>(_group_name.c_str()),
-                const_cast<char*>(destination_replica_number.c_str())};
-
-            addKeyVal(&set_op.condInput, ADMIN_KW, "");
-
-            auto status = rcModAVUMetadata(comm_, &set_op);
+            const auto status = catalog_->set_data_object_metadata(
+                comm_, _object_path, config_.group_attribute, _group_name, destination_replica_number);
             if (status < 0) {
                 const auto msg = fmt::format(
                     "{}: failed to set tier group [{}] metadata for [{}]", __func__, _group_name, _object_path);
@@ -0,0 +1,97 @@
+#include "irods/private/storage_tiering/transfer_estimate.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+
+namespace {
+    // The weight given to the most recent observation in the smoothed throughput.
+    constexpr double smoothing_factor = 0.3;
+
+    // Changes in throughput smaller than this fraction are treated as noise.
+    constexpr double significant_change = 0.05;
+
+    template <typename T>
+    auto parse_field(const char*& _first, const char* _last, T& _value) -> bool
+    {
+        const auto [ptr, ec] = std::from_chars(_first, _last, _value);
+        if (ec != std::errc{}) {
+            return false;
+        }
+
+        _first = ptr;
+        if (_first != _last) {
+            if (*_first != ':') {
+                return false;
+            }
+            ++_first;
+        }
+
+        return true;
+    } // parse_field
+} // namespace
+
+namespace irods {
+    auto transfer_estimate::initial(int _maximum_number_of_threads) -> transfer_estimate
+    {
+        return {std::clamp(4, 1, std::max(_maximum_number_of_threads, 1)), 0.0, 1};
+    } // initial
+
+    auto transfer_estimate::from_string(const std::string& _value) -> std::optional<transfer_estimate>
+    {
+        transfer_estimate estimate{};
+        const char* first = _value.data();
+        const char* last = first + _value.size();
+
+        // The throughput is stored in whole bytes per second.
+        std::int64_t bytes_per_second{};
+
+        if (!parse_field(first, last, estimate.number_of_threads) || !parse_field(first, last, bytes_per_second) ||
+            !parse_field(first, last, estimate.direction) || first != last)
+        {
+            return std::nullopt;
+        }
+
+        if (estimate.number_of_threads < 1 || bytes_per_second < 0) {
+            return std::nullopt;
+        }
+
+        estimate.bytes_per_second = static_cast<double>(bytes_per_second);
+        estimate.direction = estimate.direction < 0 ? -1 : 1;
+
+        return estimate;
+    } // from_string
+
+    auto transfer_estimate::to_string() const -> std::string
+    {
+        return fmt::format("{}:{:.0f}:{}", number_of_threads, bytes_per_second, direction);
+    } // to_string
+
+    auto transfer_estimate::update(double _observed_bytes_per_second, int _maximum_number_of_threads) const
+        -> transfer_estimate
+    {
+        const auto maximum = std::max(_maximum_number_of_threads, 1);
+
+        // The first measurement only establishes the baseline.
+        if (bytes_per_second <= 0) {
+            return {std::clamp(number_of_threads + direction, 1, maximum), _observed_bytes_per_second, direction};
+        }
+
+        auto next_direction = direction;
+        if (_observed_bytes_per_second < bytes_per_second * (1 - significant_change)) {
+            next_direction = -direction;
+        }
+        else if (_observed_bytes_per_second <= bytes_per_second * (1 + significant_change)) {
+            // No meaningful difference, so stay put.
+            next_direction = 0;
+        }
+
+        const auto smoothed = smoothing_factor * _observed_bytes_per_second + (1 - smoothing_factor) * bytes_per_second;
+        const auto threads = std::clamp(number_of_threads + next_direction, 1, maximum);
+
+        return {threads, smoothed, 0 == next_direction ? direction : next_direction};
+    } // update
+} // namespace irods
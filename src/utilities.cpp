@@ -1,8 +1,16 @@
 #include "irods/private/storage_tiering/utilities.hpp"
 
+#include <irods/escape_utilities.hpp>
+#include <irods/irods_virtual_path.hpp>
 #include <irods/rcMisc.h>
 
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fmt/format.h>
+
 #include <cstring>
+#include <set>
 
 namespace irods {
     std::string any_to_string(boost::any& _a) {
@@ -92,5 +100,58 @@ namespace irods {
 
     } // invoke_policy 
 
+    auto make_logical_path_query_chunks(const std::vector<std::string>& _logical_paths,
+                                        std::size_t _maximum_condition_length)
+        -> std::vector<logical_path_query_chunk> {
+        std::vector<logical_path_query_chunk> chunks;
+        std::set<std::string> collection_names;
+        std::set<std::string> data_names;
+
+        for(const auto& lp : _logical_paths) {
+            boost::filesystem::path p{single_quotes_to_hex(lp)};
+            const auto coll_name = fmt::format("'{}',", p.parent_path().string());
+            const auto data_name = fmt::format("'{}',", p.filename().string());
+
+            const auto added_length = (collection_names.count(coll_name) ? 0 : coll_name.size()) +
+                                      (data_names.count(data_name) ? 0 : data_name.size());
+
+            if(chunks.empty() ||
+               (!chunks.back().logical_paths.empty() &&
+                chunks.back().collection_names.size() + chunks.back().data_names.size() + added_length >
+                    _maximum_condition_length)) {
+                chunks.emplace_back();
+                collection_names.clear();
+                data_names.clear();
+            }
+
+            auto& chunk = chunks.back();
+            if(collection_names.insert(coll_name).second) {
+                chunk.collection_names += coll_name;
+            }
+            if(data_names.insert(data_name).second) {
+                chunk.data_names += data_name;
+            }
+            chunk.logical_paths.push_back(lp);
+        }
+
+        // Pop off the trailing commas to ensure valid queries.
+        for(auto& chunk : chunks) {
+            chunk.collection_names.pop_back();
+            chunk.data_names.pop_back();
+        }
+
+        return chunks;
+    } // make_logical_path_query_chunks
+
+    auto make_logical_path(const std::string& _collection_name, const std::string& _data_name) -> std::string {
+        auto logical_path = _collection_name;
+        const auto& vps = get_virtual_path_separator();
+        if(!boost::ends_with(logical_path, vps)) {
+            logical_path += vps;
+        }
+        logical_path += _data_name;
+        return logical_path;
+    } // make_logical_path
+
 } // namespace irods
 
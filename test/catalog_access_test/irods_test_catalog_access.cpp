@@ -0,0 +1,399 @@
+#include "irods/private/storage_tiering/catalog_access.hpp"
+
+#include <irods/irods_exception.hpp>
+#include <irods/rodsErrorTable.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <latch>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// This program checks that coalescing_catalog_access gives each caller the same answer the backend would have given
+// it alone. The backend is replaced by an in-memory stand-in which records every request it receives, so no server
+// is needed. The program exits with a non-zero status if any check fails.
+//
+// NOTE: This program is only intended for testing. Do not use in production.
+
+namespace {
+    using avu_list = irods::catalog_access::avu_list;
+
+    const std::string access_time_attribute{"irods::access_time"};
+    const std::string group_attribute{"irods::storage_tiering::group"};
+    // Lookups of this attribute fail in the backend.
+    const std::string failing_attribute{"irods::failing"};
+    const std::string leaf_ids{"'10001','10002'"};
+
+    // The window is long enough for every thread in a check to join the same request.
+    constexpr std::chrono::microseconds window{100'000};
+
+    auto logical_path(int _i) -> std::string
+    {
+        return fmt::format("/tempZone/home/rods/coll_{}/object_{}", _i % 3, _i);
+    } // logical_path
+
+    // Answers lookups for the even numbered objects below 100, so that the odd numbered ones are misses.
+    class fake_catalog final : public irods::catalog_access {
+      public:
+        using catalog_access::data_object_metadata;
+
+        auto data_object_metadata(RcComm*,
+                                  const std::vector<std::string>& _logical_paths,
+                                  const std::string& _attribute_name) -> std::map<std::string, avu_list> override
+        {
+            record(_attribute_name, _logical_paths);
+
+            if (failing_attribute == _attribute_name) {
+                THROW(SYS_LIBRARY_ERROR, "lookup failed in the fake catalog");
+            }
+
+            std::map<std::string, avu_list> results;
+            for (const auto& lp : _logical_paths) {
+                if (const auto i = object_number(lp); i) {
+                    results[lp] = {{fmt::format("{}:{}", _attribute_name, *i), ""}};
+                }
+            }
+
+            return results;
+        } // data_object_metadata
+
+        auto replica_numbers(RcComm*, const std::vector<std::string>& _logical_paths, const std::string& _leaf_ids)
+            -> std::map<std::string, std::string> override
+        {
+            record(_leaf_ids, _logical_paths);
+
+            std::map<std::string, std::string> results;
+            for (const auto& lp : _logical_paths) {
+                if (const auto i = object_number(lp); i) {
+                    results[lp] = std::to_string(*i % 4);
+                }
+            }
+
+            return results;
+        } // replica_numbers
+
+        auto set_data_object_metadata(RcComm*,
+                                      const std::string& _logical_path,
+                                      const std::string& _attribute_name,
+                                      const std::string&,
+                                      const std::string&) -> int override
+        {
+            record(_attribute_name, {_logical_path});
+            return 0;
+        } // set_data_object_metadata
+
+        auto change_data_object_metadata_units(RcComm*,
+                                               const std::string& _logical_path,
+                                               const std::string& _attribute_name,
+                                               const std::string&,
+                                               const std::string&,
+                                               const std::string&) -> int override
+        {
+            record(_attribute_name, {_logical_path});
+            return CAT_SUCCESS_BUT_WITH_NO_INFO;
+        } // change_data_object_metadata_units
+
+        // Answers every query with one row holding the query string.
+        void for_each_row(RcComm*,
+                          const std::string& _query_string,
+                          std::uint32_t,
+                          const std::string&,
+                          const std::function<bool(const result_row&)>& _on_row) override
+        {
+            record(_query_string, {});
+            _on_row({_query_string});
+        } // for_each_row
+
+        auto set_resource_metadata(RcComm*,
+                                   const std::string& _resource_name,
+                                   const std::string& _attribute_name,
+                                   const std::string&) -> int override
+        {
+            record(_attribute_name, {_resource_name});
+            return 0;
+        } // set_resource_metadata
+
+        auto execute_rule(RcComm*, const std::string& _rule_text) -> int override
+        {
+            record(_rule_text, {});
+            return SYS_NOT_SUPPORTED;
+        } // execute_rule
+
+        auto leaf_id_list(const std::string&) -> std::string override
+        {
+            return leaf_ids;
+        } // leaf_id_list
+
+        // The requests received for one kind of lookup, each as the list of logical paths it asked about.
+        auto requests(const std::string& _kind) -> std::vector<std::vector<std::string>>
+        {
+            const std::lock_guard lock{mutex_};
+            return requests_[_kind];
+        } // requests
+
+        void clear()
+        {
+            const std::lock_guard lock{mutex_};
+            requests_.clear();
+        } // clear
+
+      private:
+        static auto object_number(const std::string& _logical_path) -> std::optional<int>
+        {
+            for (int i = 0; i < 100; i += 2) {
+                if (logical_path(i) == _logical_path) {
+                    return i;
+                }
+            }
+
+            return std::nullopt;
+        } // object_number
+
+        void record(const std::string& _kind, const std::vector<std::string>& _logical_paths)
+        {
+            const std::lock_guard lock{mutex_};
+            requests_[_kind].push_back(_logical_paths);
+        } // record
+
+        std::mutex mutex_;
+        std::map<std::string, std::vector<std::vector<std::string>>> requests_;
+    }; // class fake_catalog
+
+    int failures = 0;
+
+    void check(bool _passed, const std::string& _description)
+    {
+        if (!_passed) {
+            ++failures;
+            std::cerr << "FAILED: " << _description << '\n';
+        }
+    } // check
+
+    // Runs each function on a thread of its own, starting them all at once.
+    void run_concurrently(const std::vector<std::function<void()>>& _functions)
+    {
+        std::latch start{static_cast<std::ptrdiff_t>(_functions.size())};
+
+        std::vector<std::thread> threads;
+        threads.reserve(_functions.size());
+        for (const auto& f : _functions) {
+            threads.emplace_back([&start, &f] {
+                start.arrive_and_wait();
+                f();
+            });
+        }
+
+        for (auto& t : threads) {
+            t.join();
+        }
+    } // run_concurrently
+
+    // Each thread asks about its own objects, some of which overlap with those of the next thread and half of which
+    // are misses. The answers must be exactly those of the backend, from far fewer requests.
+    void check_coalesced_results_match_the_backend()
+    {
+        auto backend = std::make_shared<fake_catalog>();
+        irods::coalescing_catalog_access coalescing{backend, window};
+
+        constexpr int number_of_threads = 8;
+
+        std::vector<std::vector<std::string>> paths(number_of_threads);
+        for (int t = 0; t < number_of_threads; ++t) {
+            for (int i = t * 4; i < t * 4 + 6; ++i) {
+                paths[t].push_back(logical_path(i));
+            }
+        }
+
+        std::vector<std::map<std::string, avu_list>> metadata(number_of_threads);
+        std::vector<std::map<std::string, std::string>> replicas(number_of_threads);
+
+        std::vector<std::function<void()>> lookups;
+        for (int t = 0; t < number_of_threads; ++t) {
+            lookups.emplace_back(
+                [&, t] { metadata[t] = coalescing.data_object_metadata(nullptr, paths[t], access_time_attribute); });
+            lookups.emplace_back([&, t] { replicas[t] = coalescing.replica_numbers(nullptr, paths[t], leaf_ids); });
+        }
+        run_concurrently(lookups);
+
+        const auto metadata_requests = backend->requests(access_time_attribute).size();
+        const auto replica_requests = backend->requests(leaf_ids).size();
+        check(metadata_requests < static_cast<std::size_t>(number_of_threads),
+              fmt::format("metadata lookups were coalesced into [{}] requests", metadata_requests));
+        check(replica_requests < static_cast<std::size_t>(number_of_threads),
+              fmt::format("replica number lookups were coalesced into [{}] requests", replica_requests));
+
+        for (int t = 0; t < number_of_threads; ++t) {
+            check(metadata[t] == backend->data_object_metadata(nullptr, paths[t], access_time_attribute),
+                  fmt::format("metadata of thread [{}] matches the backend", t));
+            check(replicas[t] == backend->replica_numbers(nullptr, paths[t], leaf_ids),
+                  fmt::format("replica numbers of thread [{}] match the backend", t));
+
+            for (const auto& lp : paths[t]) {
+                const bool hit = (metadata[t].count(lp) > 0);
+                check(hit == (replicas[t].count(lp) > 0), fmt::format("[{}] is a hit or a miss in both lookups", lp));
+            }
+
+            check(metadata[t].size() == paths[t].size() / 2,
+                  fmt::format("misses of thread [{}] are left out of its results", t));
+        }
+    } // check_coalesced_results_match_the_backend
+
+    // Lookups of different attributes are separate requests, and a request never grows beyond the maximum.
+    void check_requests_are_kept_apart_and_limited()
+    {
+        auto backend = std::make_shared<fake_catalog>();
+        constexpr std::size_t maximum_objects = 5;
+        irods::coalescing_catalog_access coalescing{backend, window, maximum_objects};
+
+        std::vector<std::string> paths;
+        for (int i = 0; i < 6; ++i) {
+            paths.push_back(logical_path(i));
+        }
+
+        std::map<std::string, avu_list> access_times;
+        std::map<std::string, avu_list> groups;
+        std::vector<std::map<std::string, avu_list>> pairs(3);
+
+        std::vector<std::function<void()>> lookups{
+            [&] { access_times = coalescing.data_object_metadata(nullptr, paths, access_time_attribute); },
+            [&] { groups = coalescing.data_object_metadata(nullptr, paths, group_attribute); }};
+        for (int t = 0; t < 3; ++t) {
+            lookups.emplace_back([&, t] {
+                const std::vector<std::string> pair{logical_path(10 + t * 2), logical_path(11 + t * 2)};
+                pairs[t] = coalescing.data_object_metadata(nullptr, pair, group_attribute);
+            });
+        }
+        run_concurrently(lookups);
+
+        check(access_times == backend->data_object_metadata(nullptr, paths, access_time_attribute),
+              "access times match the backend");
+        check(groups == backend->data_object_metadata(nullptr, paths, group_attribute), "groups match the backend");
+
+        for (int t = 0; t < 3; ++t) {
+            const auto& results = pairs[t];
+            check(results.size() == 1 && results.count(logical_path(10 + t * 2)) > 0,
+                  fmt::format("pair [{}] gets only its own hit", t));
+        }
+
+        backend->clear();
+        coalescing.data_object_metadata(nullptr, paths, access_time_attribute);
+        for (const auto& request : backend->requests(access_time_attribute)) {
+            check(request == paths, "a lookup larger than the maximum is sent on its own");
+        }
+
+        backend->clear();
+        std::vector<std::function<void()>> single_lookups;
+        for (const auto& lp : paths) {
+            single_lookups.emplace_back([&] { coalescing.data_object_metadata(nullptr, lp, group_attribute); });
+        }
+        run_concurrently(single_lookups);
+        for (const auto& request : backend->requests(group_attribute)) {
+            check(request.size() <= maximum_objects,
+                  fmt::format("request of [{}] objects is within the maximum", request.size()));
+        }
+    } // check_requests_are_kept_apart_and_limited
+
+    // An error from the backend reaches every thread which took part in the failed request, and no other.
+    void check_errors_reach_the_right_callers()
+    {
+        auto backend = std::make_shared<fake_catalog>();
+        irods::coalescing_catalog_access coalescing{backend, window};
+
+        constexpr int number_of_threads = 4;
+
+        std::vector<std::optional<int>> errors(number_of_threads);
+        std::vector<std::map<std::string, avu_list>> results(number_of_threads);
+
+        std::vector<std::function<void()>> lookups;
+        for (int t = 0; t < number_of_threads; ++t) {
+            // Even numbered threads ask for the failing attribute.
+            const auto attribute = 0 == t % 2 ? failing_attribute : access_time_attribute;
+            lookups.emplace_back([&, t, attribute] {
+                try {
+                    const std::vector<std::string> paths{logical_path(t * 2)};
+                    results[t] = coalescing.data_object_metadata(nullptr, paths, attribute);
+                }
+                catch (const irods::exception& e) {
+                    errors[t] = e.code();
+                }
+            });
+        }
+        run_concurrently(lookups);
+
+        for (int t = 0; t < number_of_threads; ++t) {
+            if (0 == t % 2) {
+                check(errors[t] && SYS_LIBRARY_ERROR == *errors[t],
+                      fmt::format("thread [{}] receives the error of its request", t));
+            }
+            else {
+                check(!errors[t] && 1 == results[t].size(), fmt::format("thread [{}] is not affected by the error", t));
+            }
+        }
+
+        // A failed request is not left open for later lookups.
+        const auto after_error = coalescing.data_object_metadata(nullptr, logical_path(0), access_time_attribute);
+        check(1 == after_error.size(), "a lookup after the error succeeds");
+    } // check_errors_reach_the_right_callers
+
+    // Writes and general queries are passed to the backend as they are, and so are their results.
+    void check_writes_are_passed_through()
+    {
+        auto backend = std::make_shared<fake_catalog>();
+        irods::coalescing_catalog_access coalescing{backend, window};
+
+        check(0 == coalescing.set_data_object_metadata(nullptr, logical_path(0), group_attribute, "example", ""),
+              "set returns the code of the backend");
+        check(CAT_SUCCESS_BUT_WITH_NO_INFO ==
+                  coalescing.change_data_object_metadata_units(
+                      nullptr, logical_path(0), access_time_attribute, "0", "", "flagged"),
+              "units change returns the code of the backend");
+        check(1 == backend->requests(group_attribute).size() && 1 == backend->requests(access_time_attribute).size(),
+              "each write is one request to the backend");
+
+        const std::string query_string{"select RESC_NAME where RESC_NAME = 'example'"};
+        const auto rows = coalescing.query_rows(nullptr, query_string);
+        check(1 == rows.size() && rows.front() == irods::catalog_access::result_row{query_string},
+              "query rows are those of the backend");
+        check(0 == coalescing.set_resource_metadata(nullptr, "example", group_attribute, "0"),
+              "resource metadata set returns the code of the backend");
+        check(SYS_NOT_SUPPORTED == coalescing.execute_rule(nullptr, "{}"), "rule returns the code of the backend");
+        check(leaf_ids == coalescing.leaf_id_list("example"), "leaf IDs are those of the backend");
+        check(1 == backend->requests(query_string).size() && 2 == backend->requests(group_attribute).size() &&
+                  1 == backend->requests("{}").size(),
+              "each general request is one request to the backend");
+    } // check_writes_are_passed_through
+} // namespace
+
+int main()
+{
+    try {
+        check_coalesced_results_match_the_backend();
+        check_requests_are_kept_apart_and_limited();
+        check_errors_reach_the_right_callers();
+        check_writes_are_passed_through();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << '\n';
+        return 1;
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed\n";
+        return 1;
+    }
+
+    std::cout << "all checks passed\n";
+    return 0;
+}
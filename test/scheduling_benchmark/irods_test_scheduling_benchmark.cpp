@@ -0,0 +1,577 @@
+#include "irods/private/storage_tiering/catalog_access.hpp"
+#include "irods/private/storage_tiering/configuration.hpp"
+#include "irods/private/storage_tiering/connection_pool.hpp"
+#include "irods/private/storage_tiering/executor.hpp"
+#include "irods/private/storage_tiering/metrics.hpp"
+#include "irods/private/storage_tiering/storage_tiering.hpp"
+#include "irods/private/storage_tiering/utilities.hpp"
+
+#include <irods/irods_exception.hpp>
+#include <irods/rcConnect.h>
+#include <irods/rodsDef.h>
+#include <irods/rodsErrorTable.h>
+#include <irods/rodsGenQuery.h>
+
+#include <boost/program_options.hpp>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+
+// This program measures the scheduling path of a tiering pass: paging through the violating query, skipping
+// replicas of objects already seen, setting the migration scheduled flag a page at a time and queueing data movement
+// rules. The pass is the one the plugin runs, with every catalog request answered by an in-memory stand-in holding
+// synthetic data objects and AVUs, so no server is needed. Results are printed as JSON so that runs can be compared
+// from one release to the next.
+//
+// NOTE: This program is only intended for testing. Do not use in production.
+
+namespace {
+    using result_row = irods::catalog_access::result_row;
+
+    const std::string instance_name{"irods_rule_engine_plugin-unified_storage_tiering-instance"};
+    const std::string group_name{"benchmark_group"};
+    const std::string source_resource{"benchmark_source"};
+    const std::string destination_resource{"benchmark_destination"};
+    const std::string source_leaf_ids{"'10001'"};
+    const std::string destination_leaf_ids{"'10002'"};
+
+    const std::string collection_prefix{"/tempZone/home/rods/benchmark_"};
+    const std::string data_name_prefix{"object_"};
+
+    // The access time attribute is one of the AVUs of each data object; the others are noise the catalog must skip.
+    constexpr std::uint32_t access_time_attribute_id = 0;
+
+    // The access times are spread evenly over this many seconds before the start of the program, so that the tier
+    // time of the source resource selects a fraction of the objects.
+    constexpr std::uint32_t access_time_range = 1'000'000;
+
+    struct catalog_options {
+        std::uint64_t number_of_objects;
+        std::uint64_t number_of_collections;
+        int replicas_per_object;
+        int avus_per_object;
+        double scheduled_fraction;
+        std::uint32_t tier_time_in_seconds;
+    };
+
+    auto peak_rss_in_kilobytes() -> long
+    {
+        rusage usage{};
+        ::getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    } // peak_rss_in_kilobytes
+
+    // Returns the quoted values of the IN condition on _column in a query string.
+    auto in_list(std::string_view _query_string, std::string_view _column) -> std::vector<std::string_view>
+    {
+        std::vector<std::string_view> values;
+
+        const auto condition = fmt::format("{} in (", _column);
+        const auto start = _query_string.find(condition);
+        if (std::string_view::npos == start) {
+            return values;
+        }
+
+        auto list = _query_string.substr(start + condition.size());
+        list = list.substr(0, list.find(')'));
+        while (list.size() > 1 && '\'' == list.front()) {
+            const auto end = list.find('\'', 1);
+            if (std::string_view::npos == end) {
+                break;
+            }
+
+            values.push_back(list.substr(1, end - 1));
+            list.remove_prefix(std::min(end + 2, list.size()));
+        }
+
+        return values;
+    } // in_list
+
+    // Synthetic data objects and their AVUs, answering the catalog requests of a tiering pass on a group of two
+    // tiers. Requests are recognized by the shape of their query strings. Each request counts as one catalog call,
+    // as it would be one round trip to the server, and queries count one call for every page of MAX_SQL_ROWS rows.
+    // Names are derived from the index of the object, so that millions of objects cost little more than their AVUs.
+    class synthetic_catalog final : public irods::catalog_access {
+      public:
+        using catalog_access::data_object_metadata;
+
+        synthetic_catalog(const catalog_options& _options, const irods::storage_tiering_configuration& _config)
+            : options_{_options}
+            , config_{_config}
+            , access_times_(_options.number_of_objects)
+            , scheduled_{std::make_unique<std::atomic<bool>[]>(_options.number_of_objects)}
+            , initially_scheduled_(_options.number_of_objects)
+            , avu_attributes_(_options.number_of_objects * static_cast<std::uint64_t>(_options.avus_per_object))
+        {
+            const auto now = static_cast<std::uint64_t>(std::time(nullptr));
+
+            std::mt19937 generator{42};
+            std::uniform_int_distribution<std::uint32_t> age{1, access_time_range};
+            std::uniform_int_distribution<std::uint32_t> attribute{1, 1000};
+            std::uniform_int_distribution<int> position{0, _options.avus_per_object - 1};
+            std::bernoulli_distribution scheduled{_options.scheduled_fraction};
+
+            const auto avus = static_cast<std::uint64_t>(_options.avus_per_object);
+            for (std::uint64_t i = 0; i < _options.number_of_objects; ++i) {
+                access_times_[i] = now - age(generator);
+                initially_scheduled_[i] = scheduled(generator);
+                scheduled_[i] = initially_scheduled_[i];
+
+                for (std::uint64_t a = 0; a < avus; ++a) {
+                    avu_attributes_[i * avus + a] = attribute(generator);
+                }
+                avu_attributes_[i * avus + position(generator)] = access_time_attribute_id;
+            }
+        }
+
+        auto data_object_metadata(RcComm*,
+                                  const std::vector<std::string>& _logical_paths,
+                                  const std::string& _attribute_name) -> std::map<std::string, avu_list> override
+        {
+            std::map<std::string, avu_list> results;
+            if (_attribute_name != config_.access_time_attribute) {
+                ++calls_;
+                return results;
+            }
+
+            for (const auto& chunk : irods::make_logical_path_query_chunks(_logical_paths)) {
+                ++calls_;
+
+                for (const auto& lp : chunk.logical_paths) {
+                    const auto i = object_index(lp);
+                    if (!i || !has_access_time(*i)) {
+                        continue;
+                    }
+
+                    results[lp] = {{std::to_string(access_times_[*i]),
+                                    scheduled_[*i] ? config_.migration_scheduled_flag : std::string{}}};
+                }
+            }
+
+            return results;
+        } // data_object_metadata
+
+        auto replica_numbers(RcComm*, const std::vector<std::string>& _logical_paths, const std::string&)
+            -> std::map<std::string, std::string> override
+        {
+            ++calls_;
+
+            std::map<std::string, std::string> results;
+            for (const auto& lp : _logical_paths) {
+                if (object_index(lp)) {
+                    results[lp] = "0";
+                }
+            }
+
+            return results;
+        } // replica_numbers
+
+        auto set_data_object_metadata(RcComm*,
+                                      const std::string& _logical_path,
+                                      const std::string& _attribute_name,
+                                      const std::string&,
+                                      const std::string& _units) -> int override
+        {
+            ++calls_;
+
+            if (const auto i = object_index(_logical_path); i && _attribute_name == config_.access_time_attribute) {
+                scheduled_[*i] = (_units == config_.migration_scheduled_flag);
+            }
+
+            return 0;
+        } // set_data_object_metadata
+
+        // Sets the migration scheduled flag as a compare and set, failing if another agent got there first.
+        auto change_data_object_metadata_units(RcComm*,
+                                               const std::string& _logical_path,
+                                               const std::string& _attribute_name,
+                                               const std::string&,
+                                               const std::string& _current_units,
+                                               const std::string& _new_units) -> int override
+        {
+            ++calls_;
+
+            const auto i = object_index(_logical_path);
+            if (!i || _attribute_name != config_.access_time_attribute ||
+                _new_units != config_.migration_scheduled_flag || _current_units == _new_units)
+            {
+                return CAT_NO_ROWS_FOUND;
+            }
+
+            return scheduled_[*i].exchange(true) ? CAT_NO_ROWS_FOUND : 0;
+        } // change_data_object_metadata_units
+
+        void for_each_row(RcComm*,
+                          const std::string& _query_string,
+                          std::uint32_t _limit,
+                          const std::string&,
+                          const std::function<bool(const result_row&)>& _on_row) override
+        {
+            std::uint64_t rows_read = 0;
+            const auto post = [&](result_row _row) {
+                if (0 == rows_read++ % MAX_SQL_ROWS) {
+                    ++calls_;
+                }
+
+                return _on_row(_row) && (0 == _limit || rows_read < _limit);
+            };
+
+            const std::string_view query_string{_query_string};
+
+            if (query_string.starts_with("select META_RESC_ATTR_UNITS, RESC_NAME where")) {
+                // The resources of the tier group.
+                if (post({"0", source_resource})) {
+                    post({"1", destination_resource});
+                }
+            }
+            else if (query_string.starts_with("select RESC_NAME, META_RESC_ATTR_NAME, META_RESC_ATTR_VALUE, "
+                                              "META_RESC_ATTR_UNITS where"))
+            {
+                // The resource metadata snapshot. Only the tier time is set, so every other setting is a default.
+                post({source_resource, config_.time_attribute, std::to_string(options_.tier_time_in_seconds), ""});
+            }
+            else if (query_string.starts_with("select DATA_NAME, COLL_NAME, USER_NAME, USER_ZONE, DATA_REPL_NUM, "
+                                              "DATA_ID where"))
+            {
+                violating_query(query_string, post);
+            }
+            else if (query_string.starts_with("select COLL_NAME, DATA_NAME, DATA_SIZE where")) {
+                data_sizes(query_string, post);
+            }
+
+            // Replicas on lower tiers and anything else the pass asks about have no rows, but still cost a call.
+            if (0 == rows_read) {
+                ++calls_;
+            }
+        } // for_each_row
+
+        auto set_resource_metadata(RcComm*, const std::string&, const std::string&, const std::string&)
+            -> int override
+        {
+            ++calls_;
+            return 0;
+        } // set_resource_metadata
+
+        auto execute_rule(RcComm*, const std::string& _rule_text) -> int override
+        {
+            ++calls_;
+            ++rules_;
+            rule_bytes_ += _rule_text.size();
+            return 0;
+        } // execute_rule
+
+        auto leaf_id_list(const std::string& _resource_name) -> std::string override
+        {
+            if (source_resource == _resource_name) {
+                return source_leaf_ids;
+            }
+
+            if (destination_resource == _resource_name) {
+                return destination_leaf_ids;
+            }
+
+            THROW(SYS_RESC_DOES_NOT_EXIST, fmt::format("resource [{}] does not exist", _resource_name));
+        } // leaf_id_list
+
+        auto violating_rows() const noexcept -> std::uint64_t
+        {
+            return violating_rows_;
+        }
+
+        auto calls() const noexcept -> std::uint64_t
+        {
+            return calls_;
+        }
+
+        auto rules() const noexcept -> std::uint64_t
+        {
+            return rules_;
+        }
+
+        auto rule_bytes() const noexcept -> std::uint64_t
+        {
+            return rule_bytes_;
+        }
+
+      private:
+        // Answers the default violating query on the source resource:
+        // DATA_NAME, COLL_NAME, USER_NAME, USER_ZONE, DATA_REPL_NUM, DATA_ID
+        // The flags are those in place when the query started, as the catalog would read them.
+        template <typename Post>
+        void violating_query(std::string_view _query_string, Post _post)
+        {
+            if (std::string_view::npos == _query_string.find(fmt::format("DATA_RESC_ID in ({})", source_leaf_ids))) {
+                return;
+            }
+
+            const std::string_view condition{"META_DATA_ATTR_VALUE < '"};
+            const auto start = _query_string.find(condition);
+            if (std::string_view::npos == start) {
+                return;
+            }
+
+            const auto value = _query_string.substr(start + condition.size());
+            std::uint64_t tier_time{};
+            std::from_chars(value.data(), value.data() + value.size(), tier_time);
+
+            for (std::uint64_t i = 0; i < options_.number_of_objects; ++i) {
+                if (access_times_[i] >= tier_time || initially_scheduled_[i] || !has_access_time(i)) {
+                    continue;
+                }
+
+                for (int r = 0; r < options_.replicas_per_object; ++r) {
+                    ++violating_rows_;
+                    if (!_post(result_row{data_name(i),
+                                          collection_name(i),
+                                          "rods",
+                                          "tempZone",
+                                          std::to_string(r),
+                                          std::to_string(i + 1)}))
+                    {
+                        return;
+                    }
+                }
+            }
+        } // violating_query
+
+        // Answers the data sizes of the replicas on the source resource matched by the IN conditions of a chunk.
+        template <typename Post>
+        void data_sizes(std::string_view _query_string, Post _post) const
+        {
+            const auto collection_names = in_list(_query_string, "COLL_NAME");
+            const std::set<std::string_view> collections(std::begin(collection_names), std::end(collection_names));
+
+            for (const auto& name : in_list(_query_string, "DATA_NAME")) {
+                const auto i = index_from_data_name(name);
+                if (!i) {
+                    continue;
+                }
+
+                auto collection = collection_name(*i);
+                if (0 == collections.count(collection)) {
+                    continue;
+                }
+
+                if (!_post(result_row{std::move(collection), std::string{name}, std::to_string(data_size(*i))})) {
+                    return;
+                }
+            }
+        } // data_sizes
+
+        auto collection_name(std::uint64_t _i) const -> std::string
+        {
+            return fmt::format("{}{}", collection_prefix, _i % options_.number_of_collections);
+        }
+
+        static auto data_name(std::uint64_t _i) -> std::string
+        {
+            return fmt::format("{}{}", data_name_prefix, _i);
+        }
+
+        // Sizes range from 4 KiB to 4 MiB.
+        static auto data_size(std::uint64_t _i) -> std::uint64_t
+        {
+            return (_i % 1024 + 1) * 4096;
+        }
+
+        auto index_from_data_name(std::string_view _data_name) const -> std::optional<std::uint64_t>
+        {
+            if (!_data_name.starts_with(data_name_prefix)) {
+                return std::nullopt;
+            }
+
+            std::uint64_t i{};
+            const auto digits = _data_name.substr(data_name_prefix.size());
+            const auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), i);
+            if (std::errc{} != ec || digits.data() + digits.size() != end || i >= options_.number_of_objects) {
+                return std::nullopt;
+            }
+
+            return i;
+        }
+
+        auto object_index(std::string_view _object_path) const -> std::optional<std::uint64_t>
+        {
+            const auto separator = _object_path.rfind('/');
+            if (std::string_view::npos == separator) {
+                return std::nullopt;
+            }
+
+            const auto i = index_from_data_name(_object_path.substr(separator + 1));
+            if (!i || _object_path.substr(0, separator) != collection_name(*i)) {
+                return std::nullopt;
+            }
+
+            return i;
+        }
+
+        // The catalog finds the access time among all of the AVUs of the object.
+        auto has_access_time(std::uint64_t _i) const -> bool
+        {
+            const auto avus = static_cast<std::uint64_t>(options_.avus_per_object);
+            const auto first = std::begin(avu_attributes_) + static_cast<std::ptrdiff_t>(_i * avus);
+            return std::find(first, first + static_cast<std::ptrdiff_t>(avus), access_time_attribute_id) !=
+                   first + static_cast<std::ptrdiff_t>(avus);
+        }
+
+        const catalog_options options_;
+        const irods::storage_tiering_configuration& config_;
+        std::vector<std::uint64_t> access_times_;
+        std::unique_ptr<std::atomic<bool>[]> scheduled_;
+        std::vector<bool> initially_scheduled_;
+        std::vector<std::uint32_t> avu_attributes_;
+
+        std::atomic<std::uint64_t> violating_rows_{0};
+        std::atomic<std::uint64_t> calls_{0};
+        std::atomic<std::uint64_t> rules_{0};
+        std::atomic<std::uint64_t> rule_bytes_{0};
+    }; // class synthetic_catalog
+} // namespace
+
+int main(int argc, char** argv)
+{
+    try {
+        namespace po = boost::program_options;
+
+        catalog_options catalog{};
+        double violating_fraction{};
+        int scheduling_threads{};
+        int scheduling_page_size{};
+        int data_movement_batch_size{};
+
+        po::options_description od("options");
+        // clang-format off
+        od.add_options()("help", "produce help message")
+            ("objects", po::value<std::uint64_t>(&catalog.number_of_objects)->default_value(1'000'000), "number of synthetic data objects")
+            ("collections", po::value<std::uint64_t>(&catalog.number_of_collections)->default_value(1000), "number of collections holding the data objects")
+            ("replicas-per-object", po::value<int>(&catalog.replicas_per_object)->default_value(1), "replicas of each data object on the source resource")
+            ("avus-per-object", po::value<int>(&catalog.avus_per_object)->default_value(4), "AVUs of each data object, including its access time")
+            ("violating-fraction", po::value<double>(&violating_fraction)->default_value(0.5), "fraction of the data objects older than the tier time")
+            ("scheduled-fraction", po::value<double>(&catalog.scheduled_fraction)->default_value(0.0), "fraction of the data objects already flagged for migration")
+            ("scheduling-threads", po::value<int>(&scheduling_threads)->default_value(4), "number of scheduling threads")
+            ("scheduling-page-size", po::value<int>(&scheduling_page_size)->default_value(100), "violating objects flagged for migration together")
+            ("data-movement-batch-size", po::value<int>(&data_movement_batch_size)->default_value(1), "violating objects moved by each delay rule");
+        // clang-format on
+
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(od).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help") > 0) {
+            std::cout << "NOTE: This program is only intended for testing. Do not use in production.\n";
+            std::cout << "Usage: irods_test_scheduling_benchmark [OPTION] ...\n";
+            std::cout << od << "\n";
+            return 0;
+        }
+
+        if (0 == catalog.number_of_collections || catalog.replicas_per_object < 1 || catalog.avus_per_object < 1 ||
+            scheduling_threads < 1 || scheduling_page_size < 1 || data_movement_batch_size < 1 ||
+            violating_fraction < 0 || violating_fraction > 1 || catalog.scheduled_fraction < 0 ||
+            catalog.scheduled_fraction > 1)
+        {
+            std::cerr << "error: invalid option value\n";
+            return 1;
+        }
+
+        catalog.tier_time_in_seconds = static_cast<std::uint32_t>((1 - violating_fraction) * access_time_range);
+
+        const auto config = std::make_shared<const irods::storage_tiering_configuration>(
+            instance_name,
+            nlohmann::json{{"number_of_scheduling_threads", scheduling_threads},
+                           {"scheduling_page_size", scheduling_page_size},
+                           {"data_movement_batch_size", data_movement_batch_size}});
+
+        using clock_type = std::chrono::steady_clock;
+
+        const auto setup_start = clock_type::now();
+        auto stand_in = std::make_shared<synthetic_catalog>(catalog, *config);
+        const auto setup_seconds = std::chrono::duration<double>{clock_type::now() - setup_start}.count();
+        const auto rss_before_pass = peak_rss_in_kilobytes();
+
+        // Every request goes to the stand-in, so the connections are never used to reach a server. The pool is the
+        // one built into this program, which hands out a single connection that is never connected.
+        RcComm comm{};
+        auto connection_pool =
+            std::make_shared<irods::storage_tiering_connection_pool>(config->number_of_scheduling_threads);
+        auto executors = std::make_shared<irods::storage_tiering_executors>(
+            config->number_of_scheduling_threads, config->number_of_concurrent_tier_transitions);
+
+        const auto pass_start = clock_type::now();
+        std::optional<int> pass_error;
+        try {
+            irods::storage_tiering st{&comm, nullptr, config, connection_pool, executors, stand_in};
+            st.apply_policy_for_tier_groups({group_name});
+        }
+        catch (const irods::exception& e) {
+            std::cerr << "error: " << e.client_display_what() << '\n';
+            pass_error = e.code();
+        }
+        const auto pass_seconds = std::chrono::duration<double>{clock_type::now() - pass_start}.count();
+
+        executors->stop();
+
+        const auto& counters =
+            irods::tiering_metrics::instance().transition(group_name, source_resource, destination_resource);
+        const std::uint64_t rows = stand_in->violating_rows();
+        const std::uint64_t objects_scanned = counters.objects_scanned;
+        const std::uint64_t objects_skipped = counters.objects_skipped;
+        const std::uint64_t objects_queued = counters.objects_queued;
+
+        // Objects neither queued nor skipped could not be scheduled.
+        const auto objects_not_scheduled =
+            objects_scanned - std::min(objects_scanned, objects_skipped + objects_queued);
+
+        const auto per_second = [pass_seconds](std::uint64_t _n) { return pass_seconds > 0 ? _n / pass_seconds : 0; };
+        const auto ratio = [](std::uint64_t _n, std::uint64_t _d) { return _d > 0 ? static_cast<double>(_n) / _d : 0; };
+
+        const nlohmann::json report{
+            {"objects", catalog.number_of_objects},
+            {"violating_rows", rows},
+            {"objects_scanned", objects_scanned},
+            {"objects_queued", objects_queued},
+            {"objects_skipped", objects_skipped},
+            {"scheduling_errors", objects_not_scheduled},
+            {"catalog_setup_seconds", setup_seconds},
+            {"pass_seconds", pass_seconds},
+            {"rows_per_second", per_second(rows)},
+            {"objects_queued_per_second", per_second(objects_queued)},
+            {"catalog_calls", stand_in->calls()},
+            {"catalog_calls_per_row", ratio(stand_in->calls(), rows)},
+            {"catalog_calls_per_object_queued", ratio(stand_in->calls(), objects_queued)},
+            {"rules_queued", stand_in->rules()},
+            {"rule_bytes", stand_in->rule_bytes()},
+            {"peak_rss_kilobytes_before_pass", rss_before_pass},
+            {"peak_rss_kilobytes", peak_rss_in_kilobytes()}};
+
+        std::cout << report.dump(4) << '\n';
+
+        return pass_error || objects_not_scheduled > 0 ? 1 : 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << '\n';
+        return 1;
+    }
+}
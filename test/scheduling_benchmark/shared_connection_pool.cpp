@@ -0,0 +1,83 @@
+#include "irods/private/storage_tiering/connection_pool.hpp"
+
+#include <irods/rcConnect.h>
+#include <irods/rcMisc.h>
+#include <irods/rodsErrorTable.h>
+
+#include <memory>
+#include <utility>
+
+// The scheduling benchmark is built with this file in place of src/connection_pool.cpp. Every request of the pass
+// is answered by the synthetic catalog, so the connections are never used to reach a server. Every caller is handed
+// the same connection, which is never connected, and nothing is ever returned to the pool.
+//
+// NOTE: This file is only intended for testing. Do not use in production.
+
+namespace {
+    RcComm shared_comm{};
+} // namespace
+
+namespace irods {
+    storage_tiering_connection_pool::connection_proxy::connection_proxy(
+        storage_tiering_connection_pool& _pool,
+        std::unique_ptr<experimental::client_connection> _conn) noexcept
+        : pool_{&_pool}
+        , conn_{std::move(_conn)}
+        , healthy_{true}
+    {
+    } // ctor
+
+    storage_tiering_connection_pool::connection_proxy::connection_proxy(connection_proxy&& _other) noexcept
+        : pool_{_other.pool_}
+        , conn_{std::move(_other.conn_)}
+        , healthy_{_other.healthy_}
+    {
+        _other.pool_ = nullptr;
+    } // move ctor
+
+    storage_tiering_connection_pool::connection_proxy::~connection_proxy() = default;
+
+    storage_tiering_connection_pool::connection_proxy::operator RcComm&() const noexcept
+    {
+        return shared_comm;
+    } // operator RcComm&
+
+    void storage_tiering_connection_pool::connection_proxy::invalidate() noexcept
+    {
+        healthy_ = false;
+    } // invalidate
+
+    storage_tiering_connection_pool::storage_tiering_connection_pool(int _size,
+                                                                     std::chrono::seconds _idle_check_interval)
+        : size_{_size}
+        , idle_check_interval_{_idle_check_interval}
+    {
+    } // ctor
+
+    auto storage_tiering_connection_pool::get_connection() -> connection_proxy
+    {
+        return connection_proxy{*this, nullptr};
+    } // get_connection
+
+    auto storage_tiering_connection_pool::size() const noexcept -> int
+    {
+        return size_;
+    } // size
+
+    auto storage_tiering_connection_pool::is_connection_error(int _error_code) noexcept -> bool
+    {
+        switch (getIrodsErrno(_error_code)) {
+            case SYS_HEADER_READ_LEN_ERR:
+            case SYS_HEADER_WRITE_LEN_ERR:
+            case SYS_SOCK_READ_TIMEDOUT:
+            case SYS_SOCK_READ_ERR:
+                return true;
+            default:
+                return false;
+        }
+    } // is_connection_error
+
+    void storage_tiering_connection_pool::return_connection(std::unique_ptr<experimental::client_connection>, bool)
+    {
+    } // return_connection
+} // namespace irods